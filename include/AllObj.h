@@ -1,17 +1,34 @@
 #pragma once
 
+#include <StreamString.h>
 #include <log.h>
 #include <Variadic.h>
-#include <ObjVar.h>
-#include <Buf.h>
+#include <objVar.h>
+#include <lexer.h>
 #include <iterator.h>
 #include <FileObj.h>
+#include <Snapshot.h>
+#include <Transport.h>
+#include <RecStream.h>
 
 //------------------- Dbg
 // #define DBG_CMD        // to see what's happening with send & received cmd
+// #define CFG_LOAD_TEXT  // load the text cfg to compare boot times with the binary one
+
+#ifdef CFG_LOAD_TEXT
+  #define CFG_LOAD_FORMAT CfgFormat::text
+#else
+  #define CFG_LOAD_FORMAT CfgFormat::binary // fallback to text if the binary doesn't match the vars
+#endif
 
 //-------------------------------
-#define MAXOBJ        18
+#define MAXOBJ        24
+#define AUTOSAVE_WAIT 3000 // ms without change before an autosave
+#define BULK_MAX      2048 // bytes, max size of a bulk cfg
+#define BULK_TIMEOUT  500  // ms, a bulk cfg stalled for longer is dropped
+#define TRANS_MAX     32   // nb of vars staged by a transaction
+#define TRANS_TIMEOUT 1000 // ms, a transaction not committed by then is dropped
+#define BENCH_LOOPS   20   // each var goes that many times through a bench
 
 #define CMD_RESERVED  '!'
 #define CMD_1ST_ID    (CMD_RESERVED + 1)
@@ -22,6 +39,9 @@ static auto CMD_SET          = "set";
 static auto CMD_GET          = "get";
 static auto CMD_INIT         = "init";
 static auto CMD_INIT_DONE    = "initdone";
+static auto CMD_DIGEST       = "digest";
+static auto CMD_BULK         = "bulk";
+static auto CMD_BULK_DONE    = "bulkdone";
 static auto CMD_UPDATE_SHORT = "U";
 
 enum class Decode :   uint8_t { compact, verbose, undefined };
@@ -41,25 +61,120 @@ class AllObj : public CfgFiles
   ArrayOfPtr_Iter(OBJVar, mOBJS, mNOBJ); 
   
   byte        mID = 0;
-  BUF         mTmpBuf;
+  Lexer       mTmpLexer;
+
+  // a transport with its own lexer & its own cursor of the changes sent
+  struct Session
+  {
+    Transport*  transport;
+    Lexer       lexer;
+  };
+
+  Session     mSessions[MAX_SESSIONS];
+  byte        mNSessions = 0;
+  Session*    mSession = nullptr; // whose cmds are being handled
+  RecStream*  mTap = nullptr;     // records what's read from the sessions
+  bool        mSandbox = false;  // the shown cmds are skipped, their effects would outlive a replay
+
+  bool        mAutoSave = false;
+  bool        mChanged  = false; // by a set cmd since the last load or save
+  ulong       mChangeTime;
+
+  // raw bytes of a bulk cfg, read right after its cmd line
+  Session*    mBulkSession = nullptr; // receiving them
+  SnapshotPtr mBulk;                  // null if they're skipped
+  size_t      mBulkLen;
+  size_t      mBulkPos;
+  ulong       mBulkTime;
+
+  // sets staged between begin & commit, applied all together on the next frame
+  // the committed ones come first, followed by those of a transaction begun before that frame
+  struct StagedSet
+  {
+    MyVar*      var;
+    byte        nbArg;
+    Args        args; // already constrained in the var range
+    TrackChange trackChange;
+    Session*    session;
+  };
+
+  StagedSet   mStaged[TRANS_MAX];
+  byte        mNStaged = 0;
+  bool        mInTransaction = false;
+  Session*    mTransSession; // only its sets are staged
+  byte        mNCommitted = 0;
+  ulong       mBeginTime;
 
   void    dbgCmd(const char* cmdKeyword, const parsedCmd& parsed, int nbArg, int* args, bool line);
   void    dbgCmd(const char* cmdKeyword, const parsedCmd& parsed, int nbArg, int* args, int min, int max);
 
-  bool    isNumber(const char* txt);
-  void    setCmd(const parsedCmd& parsed, BUF& buf, TrackChange trackChange);
+  void    setChanged() { mChanged = true; mChangeTime = millis(); };
+  void    setVar(MyVar* var, const Args& args, byte nbArg, TrackChange trackChange, Session* session);
+  void    setCmd(const parsedCmd& parsed, Lexer& lexer, TrackChange trackChange);
   void    getCmd(const parsedCmd& parsed, Stream& stream, Decode decode);
   void    initCmd(const parsedCmd& parsed, Stream& stream);
-  bool    parseCmd(parsedCmd& parsed, BUF& buf);
-  void    handleCmd(Stream& stream, BUF& buf, TrackChange trackChange, Decode decode);
+  bool    parseCmd(parsedCmd& parsed, Lexer& lexer);
+  void    handleCmd(Stream& stream, Lexer& lexer, TrackChange trackChange, Decode decode);
+  void    readBulk(Stream& stream, TrackChange trackChange);
+  void    readSession(Session& session);
+  void    stageSet(MyVar* var, const Args& args, byte nbArg, TrackChange trackChange, Session* session, byte from);
+  int     findStaged(MyVar* var, byte from, byte to);
+  void    dropTransaction(const char* reason);
+
+  void    hashVar(CRC32& crc, MyVar* var);
+  bool    inSnapshot(OBJVar* obj, MyVar* var, SnapFilter filter);
+  void    applySnapshot(const byte* from, const byte* to, uint16_t ratio, TrackChange trackChange);
+  bool    loadBinary(CfgType cfgtype, TrackChange trackChange);
+  void    loadText(CfgType cfgtype, TrackChange trackChange);
   
 protected:
-  void readCmd(Stream& stream, BUF& buf, TrackChange trackChange, Decode decode);
+  void readCmd(Stream& stream, Lexer& lexer, TrackChange trackChange, Decode decode);
   void CmdAllVars(Stream& stream, const char* cmdKeyword, TrackChange trackChange, Decode decode, MyVar::TestFunc test = nullptr);
 
+  // the session of the cmd being handled, nullptr if not in readSessions()
+  Transport* getTransport() { return mSession != nullptr ? mSession->transport : nullptr; };
+  void       sendChanges(Stream& stream); // since the last ones sent to the session
+  void       syncSession();               // the session has all the current values
+
 public:
-  void save(CfgType cfgtype);
-  void load(CfgType cfgtype, TrackChange trackChange = TrackChange::yes);
+  void save(CfgType cfgtype); // written in the background
+  void load(CfgType cfgtype, TrackChange trackChange = TrackChange::yes, CfgFormat format = CFG_LOAD_FORMAT);
+
+  // hash of the shown vars names, IDs & ranges, the phone caches the inits with it
+  uint32_t    getDigest();
+
+  // whole config as a single binary blob
+  uint32_t    getSchema(SnapFilter filter);
+  size_t      getSnapshotSize(SnapFilter filter);
+  bool        snapshot(byte* blob, size_t len, SnapFilter filter);
+  SnapshotPtr snapshot(SnapFilter filter, size_t& len);
+  bool        isValid(const byte* blob, size_t len);
+  bool        restore(const byte* blob, size_t len, TrackChange trackChange);
+  void        restoreLerp(const byte* from, const byte* to, uint16_t ratio, TrackChange trackChange); // both valid & with the same filter
+  void        touch(SnapFilter filter); // its vars are sent to all the sessions, even those synced with an in-between value
+
+  // cmds read from all the sessions & answered to the session that sent them
+  bool        addSession(Transport& transport);
+  void        readSessions();
+  void        replaySession(Transport& transport); // only its cmds, without the shown ones
+  void        setTap(RecStream* tap) { mTap = tap; };
+
+  // whole shown cfg in one transfer: "bulk len" + len raw bytes of a snapshot
+  void        beginBulk(int len); // the next len bytes of the session
+  void        sendBulk(Stream& stream);
+
+  // sets between a begin & a commit cmds are only applied by applyTransaction()
+  void        beginTransaction();
+  void        commitTransaction();
+  void        applyTransaction(); // on a frame boundary
+
+  // times the names lookup, the set & get dispatch, the text save & the cmds reading, logged as csv
+  void        bench(); // not while the cmds are handled
+
+  // save the current cfg when the set cmds have stopped for AUTOSAVE_WAIT
+  void setAutoSave(bool autoSave) { mAutoSave = autoSave; };
+  bool getAutoSave()              { return mAutoSave; };
+  void update();
   
   bool addObj(OBJVar& obj, const char* name);
   OBJVar* getObjFromName(const char* name);
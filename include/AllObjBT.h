@@ -1,20 +1,16 @@
 #pragma once
 
-#include <Bluetooth.h>
 #include <mpu.h>
 #include <AllObj.h>
-#include <Buf.h>
 
 #define CMD_MPU_UPDATE CMD_RESERVED
 
+// the phone protocol, answered to the session of the cmd whatever its transport
 class AllObjBT : public AllObj
 {
-  BUF mBTbuf;
-
 public:
-  AllObjBT() { mBTbuf.clear(); };
-  
-  void receiveUpdate(BlueTooth& BT);
-  void sendUpdate(BlueTooth& BT, MPU& mpu);
-  void sendInits(BlueTooth& BT);
+  void sendUpdate(MPU& mpu);
+  void sendInits();              // all the inits, then the digest
+  void sendInits(int digest);    // only the values if the phone has the same digest
+  void sendBulk();
 };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <TripleBuffer.h>
+#include <helper_3dmath.h>  // vector
+
+//----------------------------- still windows
+#define BIAS_WINDOW       64    // samples, a power of 2
+#define BIAS_STILL_W      24    // max - min gyro on each axis over a window, 16.4 = 1°/s
+#define BIAS_STILL_ACC    200   // max - min accel on each axis over a window, 1g = 8192
+
+//----------------------------- estimator & offsets
+#define BIAS_GAIN         3     // the estimate moves 1/8 of the way to each still window mean
+#define BIAS_OFFSET_SCALE 2     // offset register LSB by gyro LSB, ±1000°/s against the ±2000°/s of the measures
+#define BIAS_STEP         2     // offset register LSB applied at most by still window
+#define BIAS_SETTLED      8     // still windows in a row with nothing left to apply before the offsets are kept
+
+//-------------------------------
+// running estimate of the gyro bias left by the offset registers, from the windows where the board stays still
+// the offsets are moved toward it a few LSB at a time so that the orientation never jumps
+// all in the mpu task, the settled offsets are handed to the loop
+class BiasEstimator
+{
+  long      mSum[3];
+  int16_t   mMinW[3],   mMaxW[3];
+  int16_t   mMinAcc[3], mMaxAcc[3];
+  byte      mN = 0;
+
+  long      mBias[3] = {}; // gyro LSB << 4
+  bool      mHasBias = false;
+  byte      mNSettled = 0;
+  bool      mChanged = false;  // offsets moved since the last settle
+
+  int16_t   mOffset[3] = {};   // registers
+
+  struct Offsets { int16_t v[3]; };
+  TripleBuffer<Offsets> mSettled; // published by the mpu task, fetched by the loop
+
+  void track(int16_t v, int16_t& mi, int16_t& ma) { mi = min(mi, v); ma = max(ma, v); };
+
+  // the still window mean in the estimate, then a step of the offsets
+  bool stillWindow()
+  {
+    bool moved = false;
+    for (byte i = 0; i < 3; i++)
+    {
+      long mean = mSum[i] >> 2; // / BIAS_WINDOW << 4
+      mBias[i] = mHasBias ? mBias[i] + ((mean - mBias[i]) >> BIAS_GAIN) : mean;
+
+      long step = constrain(-mBias[i] * BIAS_OFFSET_SCALE / 16, -BIAS_STEP, BIAS_STEP);
+      if (step)
+      {
+        mOffset[i] += step;
+        mBias[i]   += step * 16 / BIAS_OFFSET_SCALE; // already removed from the next measures
+        moved = true;
+      }
+    }
+    mHasBias = true;
+
+    if (moved)
+    {
+      mChanged = true;
+      mNSettled = 0;
+    }
+    else if (mChanged && ++mNSettled >= BIAS_SETTLED)
+    {
+      mChanged = false;
+      memcpy(mSettled.back().v, mOffset, sizeof(mOffset));
+      mSettled.publish();
+    }
+    return moved;
+  };
+
+public:
+  // -- mpu task
+  void reset(const int16_t* offset) // registers set elsewhere
+  {
+    memcpy(mOffset, offset, sizeof(mOffset));
+    mN = 0;
+    mHasBias = false;
+    mNSettled = 0;
+    mChanged = false;
+  };
+
+  // true when the offsets have to be written
+  bool push(const VectorInt16& w, const VectorInt16& acc)
+  {
+    const int16_t vw[3]   = { w.x, w.y, w.z };
+    const int16_t vacc[3] = { acc.x, acc.y, acc.z };
+
+    if (mN == 0)
+      for (byte i = 0; i < 3; i++)
+      {
+        mSum[i] = 0;
+        mMinW[i]   = mMaxW[i]   = vw[i];
+        mMinAcc[i] = mMaxAcc[i] = vacc[i];
+      }
+
+    bool still = true;
+    for (byte i = 0; i < 3; i++)
+    {
+      mSum[i] += vw[i];
+      track(vw[i],   mMinW[i],   mMaxW[i]);
+      track(vacc[i], mMinAcc[i], mMaxAcc[i]);
+      still &= mMaxW[i] - mMinW[i] <= BIAS_STILL_W && mMaxAcc[i] - mMinAcc[i] <= BIAS_STILL_ACC;
+    }
+
+    if (!still)
+    {
+      mN = 0; // a new window from the next sample
+      return false;
+    }
+
+    mN = (mN + 1) & (BIAS_WINDOW - 1);
+    return mN == 0 && stillWindow();
+  };
+
+  const int16_t* getOffset() { return mOffset; };
+
+  // -- loop
+  const int16_t* settled() { return mSettled.fetch() ? mSettled.front().v : nullptr; }; // once by settle
+};
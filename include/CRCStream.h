@@ -0,0 +1,57 @@
+#pragma once
+
+#include <FS.h>
+#include <CRC32.h>
+
+// Stream around a File that updates a CRC with all the bytes written or read through it
+class CRCStream : public Stream
+{
+  File&   mFile;
+  CRC32   mCRC;
+
+public:
+  CRCStream(File& file) : mFile(file) {};
+
+  uint32_t getCRC() { return mCRC.finalize(); };
+
+  // Print
+  size_t write(uint8_t c)
+  {
+    size_t n = mFile.write(c);
+    if (n) mCRC.update(c);
+    return n;
+  };
+
+  size_t write(const uint8_t* buf, size_t len)
+  {
+    size_t n = mFile.write(buf, len);
+    mCRC.update(buf, n);
+    return n;
+  };
+
+  // Stream
+  int available() { return mFile.available(); };
+  int peek()      { return mFile.peek(); };
+  void flush()    { mFile.flush(); };
+
+  int read()
+  {
+    int c = mFile.read();
+    if (c >= 0) mCRC.update((uint8_t)c);
+    return c;
+  };
+
+  size_t read(uint8_t* buf, size_t len)
+  {
+    size_t n = mFile.read(buf, len);
+    mCRC.update(buf, n);
+    return n;
+  };
+
+  // read what's left so that the CRC covers the whole file
+  void readAll()
+  {
+    uint8_t buf[64];
+    while (read(buf, sizeof(buf)) > 0);
+  };
+};
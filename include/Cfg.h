@@ -7,6 +7,7 @@
 #define   BT_TICK       30      // ms, bluetooth update
 #define   WIFI_TICK     30      // ms, wifi update for OTA, telnet & led debug
 #define   MPU_TICK      10      // ms, MPU internaly updates every 10ms
+#define   CFG_TICK      100     // ms, autosave check
 
 #define   NLED_MID      72
 #define   NLED_TIP      36
@@ -62,23 +63,28 @@ struct Tweaks : public OBJVar
 // ---- Cmds
 struct CFG : public OBJVar
 {
-  #ifdef USE_BT
-    AllObjBT&  allObj; 
-    BlueTooth& bt; 
-    MPU&       mpu;
-    
-    CFG(AllObjBT& allObj, BlueTooth& bt, MPU& mpu) : allObj(allObj), bt(bt), mpu(mpu) {};
-
-    void init()
-    {
-      AddCmd   ("save",      allObj.save(CfgType::Current) ) // save not default
-      AddCmd   ("load",      allObj.load(CfgType::Current) ) // load not default
-      AddCmd   ("default",   allObj.load(CfgType::Default) ) // load default
-      AddCmd   ("reset",     ESP.restart()                 ) // reset
-      AddCmdHid("getInits",  allObj.sendInits(bt)          ) // answer with all vars init (min, max, value)
-      AddCmdHid("getUpdate", allObj.sendUpdate(bt, mpu)    ) // answer with all updates
-    };
-  #else
-    void init(){};
-  #endif
+  AllObjBT&  allObj; 
+  MPU&       mpu;
+  
+  CFG(AllObjBT& allObj, MPU& mpu) : allObj(allObj), mpu(mpu) {};
+
+  // the answers go to the session that sent the cmd
+  void init()
+  {
+    setInPreset(false);
+
+    AddCmd   ("save",      allObj.save(CfgType::Current) ) // save not default
+    AddCmd   ("load",      allObj.load(CfgType::Current) ) // load not default
+    AddCmd   ("default",   allObj.load(CfgType::Default) ) // load default
+    AddCmd   ("import",    allObj.load(CfgType::Current, TrackChange::yes, CfgFormat::text) ) // load the text cfg, not the binary one
+    AddCmd   ("reset",     ESP.restart()                 ) // reset
+    AddVarCode("autoSave", allObj.setAutoSave(args[0]), allObj.getAutoSave(), false, 0, 1) // save in the background when set cmds stop
+    AddCmdHid("getInits",  allObj.sendInits()            ) // answer with all vars init (min, max, value)
+    AddCmdArgHid("haveDigest", allObj.sendInits(args[0]), INT_MIN, INT_MAX) // answer with only the values if the phone inits are up to date
+    AddCmdHid("getUpdate", allObj.sendUpdate(mpu)        ) // answer with all updates
+    AddCmdHid("begin",     allObj.beginTransaction()     ) // the next sets are staged...
+    AddCmdHid("commit",    allObj.commitTransaction()    ) // ...& applied together on the next frame
+    AddCmdHid("getBulk",   allObj.sendBulk()             ) // answer with the whole cfg as a single binary block
+    AddCmdArgHid("bulk",   allObj.beginBulk(args[0]), 0, INT_MAX) // followed by the whole cfg as a single binary block
+  };
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <WiFi.h>
+#include <Transport.h>
+#include <log.h>
+
+#define CMD_PORT 8023 // same cmds as the BT ones, on a socket
+
+// a cmd session on a single TCP client
+class CmdServer : public Transport
+{
+  WiFiServer mServer = WiFiServer(CMD_PORT);
+  WiFiClient mClient;
+
+  bool mConnected = false; 
+  bool mWasConnected = false;
+  bool mHasBegun = false;
+
+  void begin();
+
+public:
+  bool update(); // in the wifi loop, when it's connected
+
+  // Transport
+  bool    isReady()   { return mConnected; };
+  Stream& getStream() { return mClient; };
+};
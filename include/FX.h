@@ -3,7 +3,7 @@
 #include <FastledCfg.h>
 #include <FastLED.h>
 #include <Streaming.h>
-#include <ObjVar.h>
+#include <objVar.h>
 
 #define ClearLeds(l, n) memset8(l, 0, n * sizeof(CRGB)); 
 #define maxCOLOR (2 << 24)
@@ -1,34 +1,63 @@
 #pragma once
 
 #include <SPIFFS.h>
-#include <CRC32.h>
+#include <CRCStream.h>
 #include <myNVS.h>
-#include <variadic.h>
+#include <Variadic.h>
+#include <Snapshot.h>
 
 //------------------- cfg
-static auto CFG_CURRENT = "/config.cfg";
-static auto CFG_DEFAULT = "/config.def";
+static auto CFG_CURRENT     = "/config.cfg";
+static auto CFG_DEFAULT     = "/config.def";
+static auto CFG_CURRENT_BIN = "/config.bin";
+static auto CFG_DEFAULT_BIN = "/default.bin";
+static auto CFG_PRESETS     = "/presets.bin";
+#define CFG_TMP_EXT   '~' // "/config.bin~" is written then renamed "/config.bin"
 
-enum class CfgType :  bool { Default, Current };
-enum class FileMode : bool { save, load };
+//------------------- background save task
+#define SAVE_CORE     0   // not on the loop core
+#define SAVE_PRIO     1   // low 
+#define SAVE_STACK    4096
+#define SAVE_QUEUE    4   // nb of files waiting to be saved
+
+enum class CfgType :   bool { Default, Current };
+enum class CfgFormat : bool { binary, text };
+enum class FileMode :  bool { save, load };
+
+//-------------------------------
+// hold the file system for the whole scope, loop & save task both use it
+class FsLock
+{
+  SemaphoreHandle_t mMutex;
+
+public:
+  FsLock(SemaphoreHandle_t mutex) : mMutex(mutex) { xSemaphoreTake(mMutex, portMAX_DELAY); };
+  ~FsLock() { xSemaphoreGive(mMutex); };
+};
 
 //-------------------------------
 class FileObj
 {
+  FsLock      mLock; // 1st to be constructed, last to be destroyed
   bool        isloading;
   MyNvs&      mNVS; // to load/save CRC
   File        f;
+  CRCStream   mStream = CRCStream(f); // crc computed on the fly
   
-  uint32_t  getCRC();
   void      handleCRC();
   void      remove();
 
 public:
-  FileObj(const char* path, FileMode mode, MyNvs& nvs);
+  FileObj(const char* path, FileMode mode, MyNvs& nvs, SemaphoreHandle_t fsMutex);
   ~FileObj();
 
   bool    ok() { return f ? true : false; };
-  Stream& getStream() { return (Stream&)f; };
+  Stream& getStream() { return mStream; };
+
+  // bulk access
+  size_t  size()                             { return f.size(); };
+  size_t  read(byte* buf, size_t len)        { return mStream.read(buf, len); };
+  size_t  write(const byte* buf, size_t len) { return mStream.write(buf, len); };
 };
 
 //-------------------------------
@@ -36,11 +65,32 @@ using FileObjPtr = std::unique_ptr<FileObj>;
 
 class CfgFiles
 {
-  bool        spiffsOK = false;
-  MyNvs       mNVS;
+  bool              spiffsOK = false;
+  MyNvs             mNVS;
+  SemaphoreHandle_t mFsMutex = xSemaphoreCreateMutex();
+  QueueHandle_t     mSaveQueue = nullptr;
+
+  struct SaveJob
+  {
+    const char* path; // static storage
+    byte*       buf;  // owned by the job
+    size_t      len;
+  };
+
+  static void saveTask(void* _cfgFiles);
+
+  const char* getPath(CfgType cfgtype, CfgFormat format);
+  void        getTmpPath(const char* path, char* tmp, size_t len);
+  bool        writeAtomic(const char* path, const byte* buf, size_t len, uint32_t crc);
+  void        recover(const char* path);
 
 public:
   void       init();
-  FileObjPtr getCfgFile(CfgType cfgtype, FileMode mode);
+  FileObjPtr getFile(const char* path, FileMode mode);
+  void       saveFile(const char* path, const byte* buf, size_t len);
+  void       saveFileAsync(const char* path, SnapshotPtr buf, size_t len);
+
+  FileObjPtr getCfgFile(CfgType cfgtype, FileMode mode, CfgFormat format = CfgFormat::text);
+  void       saveCfgFileAsync(CfgType cfgtype, CfgFormat format, SnapshotPtr buf, size_t len);
 };
 
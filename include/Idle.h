@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Presets.h>
+#include <MotionEvents.h>
+
+#define IDLE_LED_TICK   50  // ms, leds update when parked
+#define IDLE_CPU_MHZ    80  // lowest clock that keeps BT & wifi running, the APB stays @ 80MHz
+#define IDLE_LOOP_WAIT  1   // ms the loop yields each turn when parked, the core waits for an interrupt meanwhile
+#define IDLE_PRESET     -1  // slot dimmed to when parked, -1 for none
+
+enum class Power : uint8_t { active, idle, count };
+
+static const char* const POWER_NAMES[] = { "active", "idle" };
+
+//-------------------------------
+// parked on the idle motion event: slower leds, no dithering, lower cpu clock & an optional preset
+// back to full rate on the 1st moving sample, the mpu task keeps its rate to see it
+class IdleMode : public OBJVar
+{
+  Presets&  mPresets;
+  bool      mAuto;
+  int       mLedTick;
+  int       mCpuMhz;
+  int       mPreset;
+  uint32_t  mActiveMhz;
+  Power     mPower = Power::active;
+  ulong     mSince = 0; // ms when the power state began
+
+  // loop times by power state
+  struct LoopStats
+  {
+    ulong    n, max;  // µs
+    uint64_t busy;    // µs, not to overflow
+    ulong    time;    // ms spent in that state
+  };
+  LoopStats mStats[int(Power::count)] = {};
+  ulong     mLoopBegin = 0;
+
+  void setAuto(bool on);
+  void park(bool on);
+
+public:
+  IdleMode(Presets& presets) : mPresets(presets) {};
+
+  void init();
+  void onMotion(MotionEvent event); // from the events popped by the loop
+
+  bool     isIdle()                  { return mPower == Power::idle; };
+  uint16_t getLedTick(uint16_t tick) { return isIdle() ? max(mLedTick, int(tick)) : tick; };
+
+  void beginLoop() { mLoopBegin = micros(); };
+  void endLoop();  // waits when parked
+  void showStats();
+};
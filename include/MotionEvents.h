@@ -0,0 +1,140 @@
+#pragma once
+
+#include <SPSCRing.h>
+
+//----------------------------- features window & events queue
+#define MOTION_WINDOW     16    // samples, a power of 2
+#define MOTION_EVENTS     16    // events waiting for the loop, a power of 2
+#define MOTION_HOLDOFF    500   // ms before the same event again
+
+//----------------------------- thresholds
+#define MOTION_BRAKE      -128  // mean acc over the window, -255 is the hardest
+#define MOTION_KICK_W     200   // peak |w| over the window, 255 is the fastest
+#define MOTION_KICK_CROSS 1     // w zero crossings over the window, more is a wobble
+#define MOTION_BUMP       4096  // peak |vertical accel|, 1g = 8192
+#define MOTION_PICKUP     4096  // gravity on the board normal below, 1g = 8192 (a 60° tilt)
+#define MOTION_IDLE_VAR   16    // acc & w variances below
+#define MOTION_IDLE_VERT  16    // vertical accel variance below, 1g = 512, a cruise still shakes the board
+#define MOTION_IDLE_TIME  5000  // ms quiet before idle
+
+enum class MotionEvent : uint8_t { brake, kickTurn, bump, pickUp, idle, moving, count };
+
+static const char* const MOTION_EVENT_NAMES[] = { "brake", "kickTurn", "bump", "pickUp", "idle", "moving" };
+
+struct MotionEventItem
+{
+  MotionEvent type;
+  ulong       time; // µs of the sample that triggered it
+};
+
+struct MotionSample
+{
+  int16_t acc;  // smoothed output
+  int16_t w;    // smoothed output
+  int16_t vert; // linear accel on the board normal, 1g = 8192
+  int16_t tilt; // gravity on the board normal, 1g = 8192
+  ulong   time; // µs
+};
+
+//-------------------------------
+// running mean & variance, peaks & zero crossings over the last samples, events edge triggered
+// fed by the mpu task, the events read by the loop
+class MotionDetector
+{
+  MotionSample mWindow[MOTION_WINDOW];
+  byte         mPos = 0;
+  byte         mLen = 0;
+  long         mSumAcc = 0, mSumAcc2 = 0;
+  long         mSumW   = 0, mSumW2   = 0;
+  long         mSumV   = 0, mSumV2   = 0; // vertical accel >> 4 not to overflow
+
+  bool         mActive[int(MotionEvent::count)] = {}; // until its condition is over
+  ulong        mLastTime[int(MotionEvent::count)] = {};
+  ulong        mQuietTime = 0; // µs when the board stopped moving
+  bool         mIdle = false;
+
+  SPSCRing<MotionEventItem, MOTION_EVENTS> mEvents;
+
+  void emit(MotionEvent type, ulong time)
+  {
+    int i = int(type);
+    if (time - mLastTime[i] < MOTION_HOLDOFF * 1000UL && mLastTime[i]) return;
+
+    mLastTime[i] = time;
+    MotionEventItem item = { type, time };
+    mEvents.push(&item, 1); // lost if the loop is late
+  };
+
+  void edge(MotionEvent type, bool on, ulong time)
+  {
+    bool& active = mActive[int(type)];
+    if (on && !active) emit(type, time);
+    active = on;
+  };
+
+public:
+  // -- mpu task
+  void push(const MotionSample& sample)
+  {
+    // running sums
+    if (mLen == MOTION_WINDOW)
+    {
+      const MotionSample& old = mWindow[mPos];
+      mSumAcc -= old.acc; mSumAcc2 -= long(old.acc) * old.acc;
+      mSumW   -= old.w;   mSumW2   -= long(old.w)   * old.w;
+      mSumV   -= old.vert >> 4; mSumV2 -= long(old.vert >> 4) * (old.vert >> 4);
+    }
+    else
+      mLen++;
+
+    mWindow[mPos] = sample;
+    mPos = (mPos + 1) & (MOTION_WINDOW - 1);
+    mSumAcc += sample.acc; mSumAcc2 += long(sample.acc) * sample.acc;
+    mSumW   += sample.w;   mSumW2   += long(sample.w)   * sample.w;
+    mSumV   += sample.vert >> 4; mSumV2 += long(sample.vert >> 4) * (sample.vert >> 4);
+
+    if (mLen < MOTION_WINDOW) return;
+
+    // features
+    long meanAcc = mSumAcc / MOTION_WINDOW;
+    long meanW   = mSumW   / MOTION_WINDOW;
+    long varAcc  = mSumAcc2 / MOTION_WINDOW - meanAcc * meanAcc;
+    long varW    = mSumW2   / MOTION_WINDOW - meanW   * meanW;
+    long meanV   = mSumV    / MOTION_WINDOW;
+    long varV    = mSumV2   / MOTION_WINDOW - meanV   * meanV;
+
+    int  peakW = 0, peakVert = 0, maxTilt = -32768, cross = 0;
+    for (byte i = 0; i < MOTION_WINDOW; i++)
+    {
+      const MotionSample& s = mWindow[i];
+      const MotionSample& prev = mWindow[(i - 1) & (MOTION_WINDOW - 1)];
+      peakW    = max(peakW,    abs(s.w));
+      peakVert = max(peakVert, abs(s.vert));
+      maxTilt  = max(maxTilt,  int(s.tilt));
+      cross   += i != mPos && (s.w ^ prev.w) < 0 && s.w && prev.w; // not across the oldest & the newest
+    }
+
+    // events
+    ulong time = sample.time;
+    edge(MotionEvent::brake,    meanAcc < MOTION_BRAKE, time);
+    edge(MotionEvent::kickTurn, peakW > MOTION_KICK_W && cross <= MOTION_KICK_CROSS, time);
+    edge(MotionEvent::bump,     peakVert > MOTION_BUMP, time);
+    edge(MotionEvent::pickUp,   maxTilt < MOTION_PICKUP, time); // the whole window tilted
+
+    bool quiet = varAcc < MOTION_IDLE_VAR && varW < MOTION_IDLE_VAR && varV < MOTION_IDLE_VERT;
+    if (!quiet)
+    {
+      mQuietTime = time;
+      if (mIdle) emit(MotionEvent::moving, time);
+      mIdle = false;
+    }
+    else if (!mIdle && time - mQuietTime > MOTION_IDLE_TIME * 1000UL)
+    {
+      emit(MotionEvent::idle, time);
+      mIdle = true;
+    }
+  };
+
+  // -- loop
+  bool pop(MotionEventItem& item) { return mEvents.pop(item); };
+};
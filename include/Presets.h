@@ -0,0 +1,34 @@
+#pragma once
+
+#include <AllObj.h>
+
+#define PRESET_N  4 // nb of slots
+
+//-------------------------------
+// slots of the shown vars values, switched with a crossfade
+class Presets : public OBJVar
+{
+  AllObj&     mAllObj;
+  size_t      mLen = 0;       // of a slot
+  SnapshotPtr mSlots;         // PRESET_N snapshots in a row, as in CFG_PRESETS
+  SnapshotPtr mFrom;          // values when the switch began
+  const byte* mTo = nullptr;  // slot faded to
+  SnapshotPtr mParked;        // values before the park, faded back to
+  bool        mIsParked = false;
+  ulong       mFadeBegin;
+  int         mFadeTime;
+
+  byte* getSlot(byte i) { return mSlots.get() + i * mLen; };
+  void  save();
+
+public:
+  Presets(AllObj& allObj) : mAllObj(allObj) {};
+
+  void init();
+  void load(); // once all objs are added
+  void select(byte i);
+  void store(byte i);
+  void park(byte i); // crossfade to a slot & back to the current values with unpark()
+  void unpark();
+  void update(); // once per frame
+};
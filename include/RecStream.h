@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+
+//-------------------------------
+// a frame is what's been read from a session in a loop, its bytes follow
+struct __attribute__((packed)) RecFrame
+{
+  uint32_t time; // ms since the recording began
+  uint16_t len;
+};
+
+// Stream around a session stream that records all the bytes read through it
+class RecStream : public Stream
+{
+  Stream*   mSrc = nullptr;
+  byte*     mBuf = nullptr;
+  size_t    mSize;
+  size_t    mLen;
+  size_t    mFrame; // where the current frame begins
+  ulong     mStart;
+  bool      mFull;
+  bool      mInFrame; // wrapped, endFrame not called yet
+
+public:
+  void begin(byte* buf, size_t size, size_t len) // len already used by a header
+  {
+    mBuf   = buf;
+    mSize  = size;
+    mLen   = len;
+    mFrame = len;
+    mStart = millis();
+    mFull  = false;
+    mInFrame = false;
+  };
+
+  size_t end() // the recorded len
+  {
+    if (mInFrame) endFrame(); // stopped by a cmd read through this stream
+    mBuf = nullptr;
+    return mLen;
+  };
+
+  bool isRecording() { return mBuf != nullptr; };
+  bool isFull()      { return mFull; };
+
+  Stream& wrap(Stream& src)
+  {
+    mSrc   = &src;
+    mFrame = mLen;
+    mInFrame = true;
+    if (mLen + sizeof(RecFrame) <= mSize)
+      mLen += sizeof(RecFrame);
+    else
+      mFull = true;
+
+    return *this;
+  };
+
+  void endFrame()
+  {
+    mInFrame = false;
+    size_t len = mLen - mFrame;
+    if (len > sizeof(RecFrame))
+    {
+      RecFrame* frame = (RecFrame*) (mBuf + mFrame);
+      frame->time = millis() - mStart;
+      frame->len  = len - sizeof(RecFrame);
+    }
+    else
+      mLen = mFrame; // nothing read
+  };
+
+  // Print
+  size_t write(uint8_t c)                      { return mSrc->write(c); };
+  size_t write(const uint8_t* buf, size_t len) { return mSrc->write(buf, len); };
+
+  // Stream
+  int  available() { return mSrc->available(); };
+  int  peek()      { return mSrc->peek(); };
+  void flush()     { mSrc->flush(); };
+
+  int read()
+  {
+    int c = mSrc->read();
+    if (c >= 0)
+    {
+      if (!mFull && mLen < mSize)
+        mBuf[mLen++] = c;
+      else
+        mFull = true;
+    }
+    return c;
+  };
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <AllObj.h>
+
+#define REC_SIZE         8192       // bytes recorded, the next ones are lost
+#define REC_MAGIC        0x31434552 // "REC1"
+#define REPLAY_OUT_SIZE  16384      // bytes of answers compared to the reference
+#define REPLAY_MAX_CMDS  256        // cmds timed by a replay
+
+static auto REC_FILE   = "/session.rec";
+static auto REPLAY_OUT = "/replay.out";
+static auto REPLAY_REF = "/replay.ref";
+
+// a recording begins with the values when it began, then the frames
+struct __attribute__((packed)) RecHeader
+{
+  uint32_t magic;
+  uint16_t snapLen;
+};
+
+//-------------------------------
+// record the cmds received by the sessions, replay them in a loopback session
+// to time the cmds & check their answers against a reference
+class Recorder : public OBJVar
+{
+  AllObj&           mAllObj;
+  RecStream         mTap;
+  SnapshotPtr       mRec;      // the last recording, its file is saved in the background
+  size_t            mRecLen = 0;
+  SnapshotPtr       mOut;      // the answers of the last replay, same
+  size_t            mOutLen = 0;
+  SnapshotPtr       mRef;      // the reference answers, same
+  size_t            mRefLen = 0;
+  LoopbackTransport mLoopback; // the replay session
+  bool              mReplay = false;
+  bool              mBench  = false;
+
+  SnapshotPtr load(const char* path, size_t& len);
+  void        record(bool on);
+  void        replay();
+  void        rebase();
+
+public:
+  Recorder(AllObj& allObj) : mAllObj(allObj) {};
+
+  void init();
+  void update(); // not while the cmds are handled
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+
+//-------------------------------
+// lock-free ring for a single producer task & a single consumer task
+// head & tail only grow, their difference is the nb of items (N a power of 2 so that it wraps right)
+template <typename T, size_t N>
+class SPSCRing
+{
+  static_assert((N & (N - 1)) == 0, "SPSCRing size must be a power of 2");
+
+  T                   mBuf[N];
+  std::atomic<size_t> mHead { 0 }; // only written by the producer
+  std::atomic<size_t> mTail { 0 }; // only written by the consumer
+
+public:
+  // -- producer
+  size_t push(const T* items, size_t len) // returns the nb of items pushed, the others are lost
+  {
+    size_t head = mHead.load(std::memory_order_relaxed);
+    size_t room = N - (head - mTail.load(std::memory_order_acquire));
+    if (len > room) len = room;
+
+    for (size_t i = 0; i < len; i++)
+      mBuf[(head + i) & (N - 1)] = items[i];
+
+    mHead.store(head + len, std::memory_order_release); // publish all the items at once
+    return len;
+  };
+
+  size_t head() const { return mHead.load(std::memory_order_relaxed); }; // where the next item will be pushed
+
+  // -- consumer
+  size_t available() const { return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_relaxed); };
+
+  bool peek(T& item) const
+  {
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire)) return false;
+
+    item = mBuf[tail & (N - 1)];
+    return true;
+  };
+
+  bool pop(T& item)
+  {
+    if (!peek(item)) return false;
+
+    mTail.fetch_add(1, std::memory_order_release);
+    return true;
+  };
+
+  void dropUntil(size_t head) // the items pushed before head() returned it
+  {
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    if (long(head - tail) > 0) mTail.store(head, std::memory_order_release);
+  };
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory> // unique_ptr
+
+#define SNAP_MAGIC    0xE58C
+#define SNAP_VERSION  1
+
+// which vars are in a snapshot, preset is the shown vars of the objs in preset
+enum class SnapFilter : uint8_t { all, shown, preset };
+
+//-------------------------------
+// a snapshot is a SnapHeader followed by the packed values of all the vars, in the AllObj order
+struct __attribute__((packed)) SnapHeader
+{
+  uint16_t    magic;
+  uint8_t     version;
+  SnapFilter  filter;
+  uint32_t    schema;  // hash of objs & vars names, IDs, nb of args & ranges
+  uint16_t    size;    // of the packed values
+  uint32_t    crc;     // of the packed values
+};
+
+using SnapshotPtr = std::unique_ptr<byte[]>;
+
+//-------------------------------
+// a value is packed little endian on the nb of bytes its var's range needs
+inline void packValue(byte*& p, int value, byte size)
+{
+  for (byte i = 0; i < size; i++, value >>= 8) 
+    *p++ = value & 0xFF;
+}
+
+inline int unpackValue(const byte*& p, byte size, bool isSigned)
+{
+  uint32_t value = 0;
+  for (byte i = 0; i < size; i++) 
+    value |= uint32_t(*p++) << (i << 3);
+  
+  if (isSigned && size < 4 && (value >> ((size << 3) - 1)) & 1) 
+    value |= ~0u << (size << 3); // sign extension
+  
+  return value;
+}
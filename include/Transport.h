@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPSCRing.h>
+
+#define TELEMETRY_MAX 48 // bytes, max size of a telemetry line
+
+//-------------------------------
+// where a cmd session reads its cmds & writes its answers
+class Transport
+{
+public:
+  virtual bool    isReady() = 0;
+  virtual Stream& getStream() = 0;
+  virtual void    flush() {}; // an answer is complete
+  virtual bool    reconnected() { return false; }; // a new client since the last call, what the previous one left is dropped
+
+  // only the latest telemetry matters, a transport might drop the older ones
+  virtual void sendTelemetry(const char* txt, size_t len) { getStream().write((const uint8_t*)txt, len); };
+};
+
+//-------------------------------
+// cmds written with inject() & answers read with drain(), to replay or check a session without a client
+#define LOOPBACK_SIZE 4096 // a whole init dump
+
+class LoopbackTransport : public Transport, public Stream
+{
+  SPSCRing<uint8_t, LOOPBACK_SIZE> mIn;
+  SPSCRing<uint8_t, LOOPBACK_SIZE> mOut;
+
+public:
+  size_t inject(const uint8_t* buf, size_t len) { return mIn.push(buf, len); };
+  size_t inject(const char* txt)                { return inject((const uint8_t*)txt, strlen(txt)); };
+
+  size_t drain(uint8_t* buf, size_t len)
+  {
+    size_t n = 0;
+    while (n < len && mOut.pop(buf[n])) n++;
+    return n;
+  };
+
+  // Transport
+  bool    isReady()   { return true; };
+  Stream& getStream() { return *this; };
+
+  // Print, what doesn't fit is lost
+  size_t write(uint8_t c)                      { return mOut.push(&c, 1); };
+  size_t write(const uint8_t* buf, size_t len) { return mOut.push(buf, len); };
+
+  // Stream
+  int  available() { return mIn.available(); };
+  int  peek()      { uint8_t c; return mIn.peek(c) ? c : -1; };
+  int  read()      { uint8_t c; return mIn.pop(c) ? c : -1; };
+  void flush()     {};
+};
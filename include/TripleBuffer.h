@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+
+//-------------------------------
+// lock-free handoff from a single writer task to a single reader task
+// the writer fills the back buffer & swaps it with the middle one, the reader swaps the middle one with its front buffer
+// so the reader always gets the newest complete item, the ones it hasn't fetched in time are lost
+template <typename T>
+class TripleBuffer
+{
+  static constexpr uint8_t FRESH = 4; // in mMiddle, the middle buffer hasn't been fetched yet
+
+  T                    mBufs[3];
+  uint8_t              mBack   = 0;     // only used by the writer
+  std::atomic<uint8_t> mMiddle { 1 };   // index | FRESH
+  uint8_t              mFront  = 2;     // only used by the reader
+
+public:
+  // -- writer
+  T&   back()    { return mBufs[mBack]; };
+  void publish() { mBack = mMiddle.exchange(mBack | FRESH, std::memory_order_acq_rel) & 3; };
+
+  // -- reader
+  bool fetch() // true if there's a new item in front()
+  {
+    if (!(mMiddle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+    mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & 3;
+    return true;
+  };
+
+  const T& front() { return mBufs[mFront]; };
+};
@@ -3,18 +3,96 @@
 #include <BluetoothSerial.h>
 #include <Pins.h>
 #include <log.h>
+#include <SPSCRing.h>
+#include <Transport.h>
+
+// #define DBG_LATENCY  // to see the time from a cmd received to the leds shown
 
 const char* const BT_SERVER_NAME = "Esk8";
 const long BT_TIMEOUT            = 30 * 1000; // sec before stopping non connected BT
+#define BT_RX_SIZE  4096 // bytes received by the BT task, waiting for the loop, room for a bulk cfg & a cmd line
+
+//------------------- send task
+#define BT_TX_SIZE  2048 // bytes written by the loop, waiting to be sent
+#define BT_TX_MTU   990  // ESP_SPP_MAX_MTU, the loop writes are gathered in packets up to that size
+#define BT_TX_CORE  0    // not on the loop core
+#define BT_TX_PRIO  1
+#define BT_TX_STACK 3072
+#define BT_TX_DROP_OLDEST  // a telemetry line not sent yet is replaced by the next one, otherwise the next one is dropped
 
-class BlueTooth
+//-------------------------------
+// read what the BT task has received without polling BluetoothSerial
+// write to a ring sent by a task, so that the loop never waits for BluetoothSerial
+class BTStream : public Stream
+{
+  BluetoothSerial&               mSerial;
+  SPSCRing<uint8_t, BT_RX_SIZE>  mRx;
+  SPSCRing<uint8_t, BT_TX_SIZE>  mTx;
+  TaskHandle_t                   mTxTask = nullptr;
+  uint8_t                        mLastTx = '\n'; // last byte sent, a cfg line might not be complete
+
+  // latest telemetry line, can be lost
+  struct Telemetry
+  {
+    byte len;
+    char txt[TELEMETRY_MAX];
+  };
+  QueueHandle_t mTelemetry = nullptr;
+
+  // stats
+  std::atomic<uint32_t> mBytes   { 0 };
+  std::atomic<uint32_t> mPackets { 0 };
+  std::atomic<uint32_t> mDrops   { 0 }; // telemetry lines
+  std::atomic<uint32_t> mBlocked { 0 }; // µs the loop waited for room in the ring
+  std::atomic<uint32_t> mRxLost  { 0 }; // bytes received with no room in the ring
+
+  // a new client, the bytes received before are the previous one's
+  std::atomic<size_t>   mRxStart   { 0 };
+  std::atomic<bool>     mNewClient { false };
+
+  static void txTask(void* _btStream);
+
+public:
+  BTStream(BluetoothSerial& serial) : mSerial(serial) {};
+  void begin();
+
+  // BT tasks
+  void   push(const uint8_t* buf, size_t len) { mRxLost += len - mRx.push(buf, len); };
+  void   newClient() { mRxStart = mRx.head(); mNewClient = true; };
+  size_t fillPacket(uint8_t* packet); // the next one to send, 0 if there's nothing
+
+  // loop
+  void sendTelemetry(const char* txt, size_t len);
+  void showStats();
+  bool reconnected(); // & the bytes of the previous client dropped
+
+  // Print
+  size_t write(uint8_t c) { return write(&c, 1); };
+  size_t write(const uint8_t* buf, size_t len);
+
+  // Stream
+  int  available() { return mRx.available(); };
+  int  peek()      { uint8_t c; return mRx.peek(c) ? c : -1; };
+  int  read()      { uint8_t c; return mRx.pop(c) ? c : -1; };
+  void flush(); // send what's been written, without waiting
+};
+
+//-------------------------------
+
+class BlueTooth : public Transport
 {
   BluetoothSerial mBTSerial;
+  BTStream        mStream { mBTSerial };
   bool mON = false;
 
+  #ifdef DBG_LATENCY
+    volatile ulong mRxTime = 0; // µs when the last data has been received
+  #endif
+
   // C callback need a static method
-  static long mStartTime;
-  static bool mConnected;
+  static long      mStartTime;
+  static bool      mConnected;
+  static BTStream* mOpened; // for onEvent
   static void onEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t* param); 
 
 public:
@@ -22,5 +100,15 @@ public:
   void start(const bool on=true);
   void toggle();
   BluetoothSerial& getSerial() { return mBTSerial; };
+  BTStream&        getStream() { return mStream; }; // cmds already received & data to send
   bool isReady();
+
+  // Transport
+  void flush()                                    { mStream.flush(); };
+  bool reconnected()                              { return mStream.reconnected(); };
+  void sendTelemetry(const char* txt, size_t len) { mStream.sendTelemetry(txt, len); };
+
+  #ifdef DBG_LATENCY
+    ulong getRxTime() { return mRxTime; };
+  #endif
 };
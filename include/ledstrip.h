@@ -4,7 +4,7 @@
 #include <FastLED.h>
 #include <log.h>
 #include <Pins.h>
-#include <ObjVar.h>
+#include <objVar.h>
 #include <FX.h>
 #include <AllObj.h>
 #include <Variadic.h>
@@ -0,0 +1,182 @@
+#pragma once
+
+#define LEX_TOKENS  8   // tokens kept by line, the next ones are lost with an error
+#define LEX_WORDS   64  // chars of all the words of a line, with their '\0'
+#define LEX_DELIM   ' '
+
+enum class LexError : uint8_t { none, tooManyTokens, wordTooLong, badNumber };
+
+//-------------------------------
+// a number or a '\0' terminated word that points in the lexer
+struct Token
+{
+  const char* word; // nullptr if it's a number
+  int         value;
+
+  bool isNumber() const { return word == nullptr; };
+};
+
+//-------------------------------
+// fed char by char, a token is done as soon as its last char arrives & the line itself is never stored
+// numbers are decimal or hex (0x), negative or not, & saturate to the int range
+class Lexer
+{
+  enum class State : uint8_t { delim, word, number, skip };
+
+  Token     mTokens[LEX_TOKENS];
+  byte      mNTokens;
+  byte      mNext;
+  char      mWords[LEX_WORDS];
+  byte      mWordsPos;
+
+  // token being lexed
+  State     mState;
+  bool      mNeg;
+  byte      mBase;
+  byte      mDigits;
+  uint32_t  mValue;
+
+  size_t    mPos;       // of the next char in the line
+  LexError  mError;
+  size_t    mErrorPos;  // of the 1st error
+
+  void setError(LexError error)
+  {
+    if (mError == LexError::none)
+    {
+      mError = error;
+      mErrorPos = mPos;
+    }
+    mState = State::skip; // the token is lost
+  };
+
+  int digit(char c)
+  {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (mBase == 16 && c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (mBase == 16 && c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  };
+
+  void beginToken(char c)
+  {
+    if (mNTokens == LEX_TOKENS)
+      setError(LexError::tooManyTokens);
+
+    else if (isdigit(c) || c == '-')
+    {
+      mState  = State::number;
+      mNeg    = c == '-';
+      mBase   = 10;
+      mDigits = 0;
+      mValue  = 0;
+      if (!mNeg) addDigit(c);
+    }
+    else
+    {
+      mState = State::word;
+      mTokens[mNTokens].word = mWords + mWordsPos;
+      addChar(c);
+    }
+  };
+
+  void addChar(char c)
+  {
+    if (mWordsPos < LEX_WORDS - 1) // room for the '\0'
+      mWords[mWordsPos++] = c;
+    else
+      setError(LexError::wordTooLong);
+  };
+
+  void addDigit(char c)
+  {
+    int d = digit(c);
+
+    if (d >= 0)
+    {
+      uint32_t max = mNeg ? uint32_t(INT_MAX) + 1 : INT_MAX;
+      mValue = mValue > (max - d) / mBase ? max : mValue * mBase + d; // saturate
+      mDigits++;
+    }
+    else if ((c == 'x' || c == 'X') && mBase == 10 && mDigits == 1 && mValue == 0) // 0x
+    {
+      mBase = 16;
+      mDigits = 0;
+    }
+    else
+      setError(LexError::badNumber);
+  };
+
+  void endToken()
+  {
+    Token& token = mTokens[mNTokens];
+
+    if (mState == State::word)
+    {
+      mWords[mWordsPos++] = '\0';
+      mNTokens++;
+    }
+    else if (mState == State::number)
+    {
+      if (mDigits == 0) // "-" or "0x"
+        setError(LexError::badNumber);
+      else
+      {
+        token.word  = nullptr;
+        token.value = mNeg ? int(-int64_t(mValue)) : int(mValue);
+        mNTokens++;
+      }
+    }
+    mState = State::delim;
+  };
+
+public:
+  Lexer() { clear(); };
+
+  // -- feed
+  void clear()
+  {
+    mNTokens  = 0;
+    mNext     = 0;
+    mWordsPos = 0;
+    mState    = State::delim;
+    mPos      = 0;
+    mError    = LexError::none;
+    mErrorPos = 0;
+  };
+
+  void append(char c)
+  {
+    if (c == LEX_DELIM)
+      endToken();
+    else switch (mState)
+    {
+      case State::delim:  beginToken(c); break;
+      case State::word:   addChar(c);    break;
+      case State::number: addDigit(c);   break;
+      default:                           break; // skip
+    }
+    mPos++;
+  };
+
+  void end() { endToken(); }; // the line is complete
+
+  void parse(const char* txt)
+  {
+    clear();
+    while (*txt) append(*txt++);
+    end();
+  };
+
+  // -- tokens
+  const Token* first() { mNext = 0; return next(); };
+  const Token* next()  { return mNext < mNTokens ? &mTokens[mNext++] : nullptr; };
+
+  const char* nextWord() // nullptr if there's none or it's a number
+  {
+    const Token* token = next();
+    return token != nullptr ? token->word : nullptr;
+  };
+
+  LexError getError(size_t& pos) { pos = mErrorPos; return mError; };
+};
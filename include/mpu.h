@@ -6,8 +6,14 @@
 #include <helper_3dmath.h>  // vector & quaternion 
 #include <log.h>
 #include <Pins.h>
-#include <ObjVar.h>
+#include <objVar.h>
 #include <Variadic.h>
+#include <TripleBuffer.h>
+#include <SPSCRing.h>
+#include <AllObj.h>
+#include <CRC32.h>
+#include <MotionEvents.h>
+#include <BiasEstimator.h>
 
 #define MPU6050_INCLUDE_DMP_MOTIONAPPS20 // so that all dmp functions are included
 #include <MPU6050.h>
@@ -20,16 +26,81 @@
 #define CALIBRATION_LOOP  6
 #define I2C_CLOCK         400000 // 400kHz 
 
+//----------------------------- bring-up, off the loop when in a task
+#define MPU_INIT_TRIES    5      // begin attempts, then the mpu stays off until a reset
+#define MPU_INIT_WAIT     1000   // ms between attempts
+
+//----------------------------- Read all the fifo packets, not only the latest one
+// #define MPU_DRAIN_FIFO
+#define MPU_DMP_RATE      100   // Hz, the dmp fifo default rate, to timestamp the packets
+#define MPU_FIFO_SIZE     1024  // bytes, the fifo overflows beyond
+#define MPU_PACKET_MAX    42    // bytes, MotionApps20 packets (28 with V6_12)
+#define MPU_BURST_MAX     255   // bytes read at once, getFIFOBytes limit
+#define MPU_SAMPLES       16    // packets waiting to be computed
+
+//----------------------------- Mahony fusion of the raw gyro & accel instead of the dmp
+// #define MPU_SOFT_FUSION
+#define MPU_FUSION_RATE   500   // Hz, up to 1000
+#define MPU_FUSION_KP     1.    // accel correction of the gyro drift, no integral term since the gyro offsets are calibrated
+
+#ifdef MPU_SOFT_FUSION
+  #undef MPU_DRAIN_FIFO // no dmp packets
+  #define MPU_TASK_PERIOD (1000 / MPU_FUSION_RATE) // ms
+#else
+  #define MPU_TASK_PERIOD 10 // ms, a dmp packet every 10ms
+#endif
+
+//----------------------------- Integer math on the Q14 dmp quaternion, LUTs instead of acos & pow
+// #define MPU_FIXED_MATH
+// #define MPU_CHECK_FIXED // compare with the float math, max errors shown by showStats()
+
+//----------------------------- Ride recorder, the last measures replayed with the current tweaks
+#define MPU_RIDE_SAMPLES  1024        // ~10s of dmp packets, the oldest are overwritten
+#define MPU_RIDE_QUEUE    64          // measures waiting for the loop, a power of 2
+#define MPU_RIDE_MAGIC    0x45444952  // "RIDE"
+static auto MPU_RIDE_FILE = "/ride.bin";
+
 //----------------------------- Smooth accel & gyro
 #define ACCEL_AVG         .05 // use 5% of the new measure in the avg
 #define ACCEL_BASE_FREQ   60. // based on a 60fps measure
 
+//----------------------------- Output extrapolated to the leds frame time with its rates
+// #define MPU_PREDICT
+#define MPU_RATE_SMOOTH   2     // the rates get 1/4 of each new one
+#define MPU_PREDICT_LEAD  2000  // µs from the leds setup to the frame shown
+#define MPU_PREDICT_MAX   30000 // µs, not extrapolated further
+#define MPU_PREDICT_DELTA 64    // max change extrapolated, on a 255 scale
+#define MPU_ANGLE_2PI     1998  // a whole turn, getAxiSAngle gives 318 / rad
+
 //----------------------------- Run in a task
-#define MPU_GET_CORE  1 // mpu on core 1 to prevent ISR hanging
+#ifndef MPU_NO_TASK // the native tests run the mpu in the loop
+  #define MPU_GET_CORE  1 // mpu on core 1 to prevent ISR hanging
+#endif
 #define MPU_GET_PRIO  0 // enough & more stable with every other ISR
-#define MPU_GET_STACK 2048
+#define MPU_GET_STACK 4096 // the replay & the logs of the task, what is left is shown by showStats()
 
 //----------------------------- 
+struct MPUSample
+{
+  ulong   time; // µs when the dmp wrote it in the fifo
+  uint8_t packet[MPU_PACKET_MAX];
+};
+
+// what compute needs from a packet
+struct __attribute__((packed)) MPURecord
+{
+  uint16_t  dt;      // µs since the previous one
+  int16_t   quat[4]; // w, x, y, z, 1 = 16384
+  int16_t   w[3];    // gyro
+  int16_t   acc[3];  // accel, 1g = 8192
+};
+
+struct __attribute__((packed)) RideHeader
+{
+  uint32_t  magic;
+  uint16_t  count; // of records that follow
+};
+
 struct SensorOutput 
 {
   VectorInt16 axis;
@@ -37,30 +108,113 @@ struct SensorOutput
   int16_t     acc = 0;
   int16_t     w = 0;
   bool        updated = false;
+  uint32_t    seq = 0;  // of the sample, 0 before the 1st one
+  ulong       time = 0; // µs when the sample was read
+
+  // by s, smoothed
+  int32_t     dAngle = 0;
+  int32_t     dAcc = 0;
+  int32_t     dW = 0;
+
+  // at a later µs, the horizon & the changes bounded so that a wrong rate can't go far
+  SensorOutput predict(ulong at) const
+  {
+    SensorOutput out = *this;
+    long dt = min(long(at - time), long(MPU_PREDICT_MAX));
+    if (dt <= 0) return out;
+
+    auto delta = [dt](int32_t rate, int32_t scale) // on a 255 scale
+    {
+      int32_t max = MPU_PREDICT_DELTA * scale / 255;
+      return constrain(int32_t(int64_t(rate) * dt / 1000000), -max, max);
+    };
+    out.angle = constrain(angle + delta(dAngle, MPU_ANGLE_2PI / 2), 0, MPU_ANGLE_2PI);
+    out.acc   = constrain(acc + delta(dAcc, 255), -255, 255);
+    out.w     = constrain(w   + delta(dW,   255), -255, 255);
+    out.time  = at;
+    return out;
+  };
 };
 
 //-----------------------------
 class MPU : public OBJVar, public MPU6050
 {
   bool        mDmpReady = false; 
-  bool        mHasBegun = false;
+
+  // bring-up
+  std::atomic<bool> mBeginAsked { false }; // by the loop, once the cfg is loaded
+  std::atomic<bool> mReady      { false };
+  byte        mTries   = 0;
+  ulong       mTryTime = 0; // ms
 
   uint8_t*    mFifoBuffer; 
+  uint16_t    mPacketSize;
   ulong       mT = 0;     // µs
   ulong       mdt = 1000; // µs
+  uint32_t    mSeq = 0;   // of the last sample computed
 
-  Quaternion  mQuat;    // quat from dmp fifobuffer
   VectorInt16 mW;       // gyro 
   VectorInt16 mAcc;     // accel 
   VectorInt16 mAccReal; // gravity-free accel
-  VectorFloat mGrav;    // measured gravity  
-  
+
+  #ifdef MPU_FIXED_MATH
+    int16_t     mQuat[4]; // w, x, y, z from dmp fifobuffer, 1 = 16384
+    VectorInt16 mGrav;    // measured gravity, 1g = 8192
+  #else
+    Quaternion  mQuat;    // quat from dmp fifobuffer
+    VectorFloat mGrav;    // measured gravity  
+  #endif
+
+  #ifdef MPU_CHECK_FIXED
+    int mMaxAngleErr  = 0;
+    int mMaxAxisErr   = 0;
+    int mMaxSmoothErr = 0;
+  #endif
+
   void getAxiSAngle(VectorInt16& v, int& angle, Quaternion& q);
+  void getAxiSAngle(VectorInt16& v, int& angle, const int16_t* q);
+
+  #ifdef MPU_SOFT_FUSION
+    float mFusion[4] = { 1, 0, 0, 0 }; // w, x, y, z
+
+    void fuse(); // mW & mAcc in mQuat, like the dmp
+  #endif
+
+  #ifdef MPU_DRAIN_FIFO
+    SPSCRing<MPUSample, MPU_SAMPLES> mSamples; // filled & emptied by the mpu task
+    uint8_t  mBurst[MPU_BURST_MAX];
+    std::atomic<uint32_t> mLost { 0 }; // packets lost by a fifo overflow, shown by showStats()
+
+    void drainFifo();
+  #endif
 
   int16_t mXGyroOffset,   mYGyroOffset,   mZGyroOffset;
   int16_t mXAccelOffset,  mYAccelOffset,  mZAccelOffset;
   bool    mGotOffset;
   bool    mAutoCalibrate;
+  bool    mBgCalibrate;   // the gyro offsets learnt while the board stays still, no blocking calibration
+
+  BiasEstimator mBias;    // fed by the mpu task
+  void    syncBias();     // with the offset registers
+
+  // ride recorder
+  AllObj*                               mAllObj = nullptr;
+  std::atomic<bool>                     mRecording { false };
+  SPSCRing<MPURecord, MPU_RIDE_QUEUE>   mRideQueue;  // from the mpu task to the loop
+  std::unique_ptr<MPURecord[]>          mRide;       // ring
+  size_t                                mRidePos;
+  size_t                                mRideLen;
+  bool                                  mReplayAsked = false;
+  std::atomic<bool>                     mReplaying { false }; // mReplay is handed to the mpu task
+  SnapshotPtr                           mReplay;
+
+  MotionDetector                        mMotion;     // fed by the mpu task
+
+  void record(bool on);
+  void replay();
+  void getMeasures();                   // from the dmp packet or the fusion
+  void process(SensorOutput& output);   // from the measures
+  MotionSample getMotionSample(const SensorOutput& output);
 
   void printOffsets(const __FlashStringHelper* txt);
   bool setOffsets();
@@ -68,6 +222,17 @@ class MPU : public OBJVar, public MPU6050
   int16_t  mAccY       = 0;
   int16_t  mWZ         = 0;
   int16_t  mAccYsmooth = 0;
+
+  // last output & its smoothed rates, by s
+  struct Rates
+  {
+    int     angle = 0;
+    int16_t acc = 0, w = 0;
+    int32_t dAngle = 0, dAcc = 0, dW = 0;
+    bool    valid = false;
+  };
+  Rates    mRates;
+  void     getRates(SensorOutput& output);
  
   // value to tweak
   uint16_t mSmoothAcc;
@@ -76,6 +241,10 @@ class MPU : public OBJVar, public MPU6050
   uint16_t mNeutralW;
   int      mMaxW; 
 
+  // handoff stats
+  uint32_t mDrops = 0; // samples computed but never seen by the loop
+  uint32_t mDups  = 0; // updates without a new sample
+
 public:
   SensorOutput  mOutput; // public outpout
 
@@ -83,8 +252,13 @@ public:
   void calibrate();
   bool getFiFoPacket();
   void compute(SensorOutput& output);
+  void checkReplay(); // handed by update()
 
-  void init();
-  void begin();
+  void init(AllObj& allObj);
+  bool begin();
+  bool bringUp(); // retries begin(), true once ready
+  bool isReady() { return mReady; };
   void update();
+  void showStats();
+  bool popEvent(MotionEventItem& event) { return mMotion.pop(event); }; // from the loop
 };
@@ -1,10 +1,11 @@
 #pragma once
 
-#include <HashName.h>
+#include <hashName.h>
 #include <iterator.h>
 
-#define MAX_VAR  16
-#define MAX_ARGS 3
+#define MAX_VAR      20
+#define MAX_ARGS     3
+#define MAX_SESSIONS 3 // cmd sessions, each with its own cursor of the changes sent
 
 //--------------------------------- 
 // abstract functor class to hide a lambda capture
@@ -47,22 +48,31 @@ class MyVar
   int         mMin, mMax;
   bool        mShow;
   byte        mID;
-  int         mLast[MAX_ARGS];
+  byte        mN;
+  int         mLast[MAX_SESSIONS][MAX_ARGS]; // last values sent to each session
+  byte        mTouched = 0;                  // a bit by session to send to, even if the value looks the same
 
 public:
   MyVar(byte n, const char* name, SetFunc* set, GetFunc* get, int def, int min, int max, bool show);
   inline const char* getName() { return mName; };
   
   void   getRange(int& min, int& max);
-  void   set(SetArgs toSet, byte n, TrackChange trackChange);
+  void   set(SetArgs toSet, byte n, TrackChange trackChange); // TrackChange::no syncs all the cursors
   byte   get(GetArgs toGet);
 
   byte   getID()        { return mID; };
   void   setID(byte id) { mID = id; };
 
+  byte   getNbArgs()    { return mN; };
+  bool   isVar()        { return mN > 0; }; // a value to get & save, not a cmd
+  bool   isSigned()     { return mMin < 0; };
+  byte   getSize();     // nb of bytes needed by an arg in a snapshot
+
   using  TestFunc = bool (MyVar::*)();
   bool   isShown()      { return mShow; };
-  bool   hasChanged();
+  void   sync(byte cursor);
+  bool   hasChanged(byte cursor);
+  void   touch()        { mTouched = (1 << MAX_SESSIONS) - 1; }; // changed for all the sessions
 };
 
 //---------------------------------
@@ -72,11 +82,15 @@ class OBJVar
   MyVar*      mVar[MAX_VAR];
   byte        mNVAR = 0;
   const char* mName;
+  bool        mInPreset = true;
 
 public:  
   void setName(const char* name) { mName = name; };
   inline const char* getName()   { return mName; };
 
+  void setInPreset(bool inPreset) { mInPreset = inPreset; };
+  bool isInPreset()               { return mInPreset; };
+
   bool   addVar(byte n, const char* name, SetFunc* set, GetFunc* get, int def = 0, int min = 0, int max = 0, bool show = true);
   MyVar* getVarFromName(const char* name);
   ArrayOfPtr_Iter(MyVar, mVar, mNVAR);
@@ -94,8 +108,18 @@ public:
   addVar(N, name, setF, getF, def, min, max, show);                                             \
 }
 
+// a cmd with 1 arg, but no value to get or save
+#define _AddCmdArg(name, min, max, show, cmd)                                                   \
+{                                                                                               \
+  SetFunc* setF = newSetFunc( [this](SetArgs args, byte n) { if (n==1) { cmd; } });             \
+  GetFunc* getF = newGetFunc( [this](GetArgs args) -> byte { return 0; });                      \
+  addVar(0, name, setF, getF, 0, min, max, show);                                               \
+}
+
 #define AddCmd(name, cmd)                                       _AddVar(0, name, 0,   0,   0,   true,  cmd)
 #define AddCmdHid(name, cmd)                                    _AddVar(0, name, 0,   0,   0,   false, cmd)
+#define AddCmdArg(name, cmd, min, max)                          _AddCmdArg(name, min, max,      true,  cmd)
+#define AddCmdArgHid(name, cmd, min, max)                       _AddCmdArg(name, min, max,      false, cmd)
 #define AddVarCode(name, set, get, def, min, max)               _AddVar(1, name, def, min, max, true,  set,           get) 
 #define AddVarName(name, var, def, min, max)                    _AddVar(1, name, def, min, max, true,  var = args[0], var) 
 #define AddVarNameHid(name, var, def, min, max)                 _AddVar(1, name, def, min, max, false, var = args[0], var) 
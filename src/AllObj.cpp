@@ -20,7 +20,7 @@ bool AllObj::addObj(OBJVar& obj, const char* name)
       var->setID(CMD_1ST_ID + mID++);
   }
   else
-    _log << ">> ERROR !! Max obj is reached " << MAXOBJ << endl; 
+    _log << ">> ERROR !! Max obj is reached " << MAXOBJ << " - " << name << " is not added" << endl; 
 
   return ok;
 }
@@ -31,16 +31,6 @@ OBJVar* AllObj::getObjFromName(const char* name)
 };
   
 //--------------------------------------
-bool AllObj::isNumber(const char* txt) 
-{ 
-  for (int i = 0; i < strlen(txt); i++) 
-    if (!(isdigit(txt[i]) || txt[i]=='-')) 
-    // if (!(isxdigit(txt[i]) || txt[i]=='-')) 
-      return false; 
-
-  return true; 
-} 
-
 void AllObj::dbgCmd(const char* cmdKeyword, const parsedCmd& parsed, int nbArg, int* args, bool line = true)
 {
   #ifdef DBG_CMD
@@ -63,8 +53,21 @@ void AllObj::dbgCmd(const char* cmdKeyword, const parsedCmd& parsed, int nbArg,
 }
 
 //--------------------------------------
+// a set received from a session is not sent back to it, but to the other sessions
+void AllObj::setVar(MyVar* var, const Args& args, byte nbArg, TrackChange trackChange, Session* session)
+{
+  if (trackChange == TrackChange::no && session != nullptr)
+  {
+    var->set(args, nbArg, TrackChange::yes);
+    var->sync(session - mSessions);
+  }
+  else
+    var->set(args, nbArg, trackChange);
+}
+
+//----------------
 // get the var args from the cmd
-void AllObj::setCmd(const parsedCmd& parsed, BUF& buf, TrackChange trackChange)
+void AllObj::setCmd(const parsedCmd& parsed, Lexer& lexer, TrackChange trackChange)
 {
   assert(trackChange != TrackChange::undefined);
   
@@ -76,15 +79,27 @@ void AllObj::setCmd(const parsedCmd& parsed, BUF& buf, TrackChange trackChange)
 
   for (; nbArg < MAX_ARGS; nbArg++) // get the args
   {
-    const char* a = buf.next();
-    if (a!=nullptr && isNumber(a))
-      // args[nbArg] = constrain(strtol(a, nullptr, 16), min, max);
-      args[nbArg] = constrain(strtol(a, nullptr, 10), min, max);
+    const Token* a = lexer.next();
+    if (a!=nullptr && a->isNumber())
+      args[nbArg] = constrain(a->value, min, max);
     else 
       break;
   }
 
-  parsed.var->set(args, nbArg, trackChange); //set the value from args
+  bool isVar = nbArg && parsed.var->isVar(); // cmds are never staged
+  if (isVar && mInTransaction && mSession == mTransSession)
+    stageSet(parsed.var, args, nbArg, trackChange, mSession, mNCommitted);
+  
+  else if (isVar && findStaged(parsed.var, 0, mNCommitted) >= 0) // late set of a committed var, it has to win on the next frame
+    stageSet(parsed.var, args, nbArg, trackChange, mSession, 0);
+  
+  else
+  {
+    if (isVar) // not a cmd, even with an arg
+      setChanged();
+
+    setVar(parsed.var, args, nbArg, trackChange, mSession); //set the value from args
+  }
   
   dbgCmd(CMD_SET, parsed , nbArg, args);
 }
@@ -138,14 +153,14 @@ void AllObj::initCmd(const parsedCmd& parsed, Stream& stream)
 }
 
 //--------------------------------------
-bool AllObj::parseCmd(parsedCmd& parsed, BUF& buf)
+bool AllObj::parseCmd(parsedCmd& parsed, Lexer& lexer)
 {
-  const char* objname = buf.next();
+  const char* objname = lexer.nextWord();
   parsed.obj = getObjFromName(objname);
   
   if(parsed.obj != nullptr)
   {
-    const char* varname = buf.next();
+    const char* varname = lexer.nextWord();
     parsed.var = parsed.obj->getVarFromName(varname); 
     
     if (parsed.var != nullptr)
@@ -155,25 +170,33 @@ bool AllObj::parseCmd(parsedCmd& parsed, BUF& buf)
 }
 
 //----------------
-void AllObj::handleCmd(Stream& stream, BUF& buf, TrackChange trackChange, Decode decode)
+void AllObj::handleCmd(Stream& stream, Lexer& lexer, TrackChange trackChange, Decode decode)
 {
-  const char* cmd = buf.first();
+  const Token* token = lexer.first();
+  const char* cmd = token != nullptr ? token->word : nullptr;
   if (cmd!=nullptr)
   {
     // shortcut for update ?
     if (strcmp(cmd, CMD_UPDATE_SHORT)==0) 
     {
-      snprintf(buf.getBuf(), buf.getLen(), "%s Cfg getUpdate", CMD_SET); // emulate a set cmd
-      cmd = buf.first();
+      char txt[32];
+      snprintf(txt, sizeof(txt), "%s Cfg getUpdate", CMD_SET); // emulate a set cmd
+      lexer.parse(txt);
+      cmd = lexer.first()->word;
     }
 
     parsedCmd parsed;
     
-    if (parseCmd(parsed, buf))
+    if (parseCmd(parsed, lexer))
     {
       // SET cmd ?
       if (strcmp(cmd, CMD_SET)==0)
-        setCmd(parsed, buf, trackChange); //read in buf and set the parsed var values
+      {
+        if (mSandbox && parsed.var->isShown() && !parsed.var->isVar()) // a cmd, not a var
+          _log << "Cmd " << parsed.obj->getName() << " " << parsed.var->getName() << " not replayed" << endl;
+        else
+          setCmd(parsed, lexer, trackChange); //read in lexer and set the parsed var values
+      }
       
       // GET cmd ?
       else if (strcmp(cmd, CMD_GET)==0)
@@ -187,21 +210,248 @@ void AllObj::handleCmd(Stream& stream, BUF& buf, TrackChange trackChange, Decode
 }
 
 //----------------
-void AllObj::readCmd(Stream& stream, BUF& buf, TrackChange trackChange, Decode decode)
+void AllObj::readCmd(Stream& stream, Lexer& lexer, TrackChange trackChange, Decode decode)
 {
+  if (mBulkSession != nullptr && mBulkSession == mSession && millis() - mBulkTime > BULK_TIMEOUT)
+  {
+    _log << "Bulk cfg timeout, " << mBulkPos << "/" << mBulkLen << " Bytes received" << endl;
+    mBulk.reset();
+    mBulkSession = nullptr;
+  }
+
   while (stream.available() > 0) 
   {
+    if (mBulkSession != nullptr && mBulkSession == mSession) // raw bytes, not a cmd
+    {
+      readBulk(stream, trackChange);
+      continue;
+    }
+
     char c = stream.read();
     if (c != CMD_ALIVE)
     {
       if (c == CMD_TERM)
       {
-        handleCmd(stream, buf, trackChange, decode);
-        buf.clear();
+        lexer.end();
+
+        size_t pos;
+        LexError error = lexer.getError(pos);
+        if (error == LexError::none)
+          handleCmd(stream, lexer, trackChange, decode);
+        else
+          _log << "Cmd dropped, lex error " << int(error) << " @ char " << pos << endl;
+
+        lexer.clear();
       }
       else if (isprint(c))
-        buf.append(c);
+        lexer.append(c);
+    }
+  }
+}
+
+//----------------
+bool AllObj::addSession(Transport& transport)
+{
+  bool ok = mNSessions < MAX_SESSIONS;
+  if (ok)
+    mSessions[mNSessions++].transport = &transport;
+  else
+    _log << ">> ERROR !! Max session is reached " << MAX_SESSIONS << endl; 
+
+  return ok;
+}
+
+void AllObj::readSession(Session& session)
+{
+  Transport& transport = *session.transport;
+
+  if (transport.reconnected()) // not the end of the previous client's line
+  {
+    session.lexer.clear();
+    if (mBulkSession == &session)
+    {
+      mBulk.reset();
+      mBulkSession = nullptr;
+    }
+  }
+
+  if (transport.isReady() && transport.getStream().available())
+  {
+    mSession = &session;
+    RecStream* tap = mTap; // might be changed by a cmd
+    Stream& stream = tap != nullptr ? tap->wrap(transport.getStream()) : transport.getStream();
+
+    // DO NOT track change or what's received would be echoed to the session
+    readCmd(stream, session.lexer, TrackChange::no, Decode::undefined); 
+    transport.flush(); // the answers if any
+
+    if (tap != nullptr && tap->isRecording()) tap->endFrame();
+    mSession = nullptr;
+  }
+}
+
+void AllObj::readSessions()
+{
+  for (byte i=0; i < mNSessions; i++)
+    readSession(mSessions[i]);
+}
+
+// the live sessions are not read, save, load, reset, calibrate, record... aren't run
+void AllObj::replaySession(Transport& transport)
+{
+  for (byte i=0; i < mNSessions; i++)
+    if (mSessions[i].transport == &transport)
+    {
+      mSandbox = true;
+      readSession(mSessions[i]);
+      mSandbox = false;
+    }
+}
+
+void AllObj::sendChanges(Stream& stream)
+{
+  byte cursor = mSession - mSessions;
+
+  for (auto obj : *this)
+    for (auto var : *obj)
+      if (var->hasChanged(cursor))
+        getCmd({ obj, var }, stream, Decode::compact);
+}
+
+void AllObj::syncSession()
+{
+  byte cursor = mSession - mSessions;
+
+  for (auto obj : *this)
+    for (auto var : *obj)
+      var->sync(cursor);
+}
+
+//----------------
+void AllObj::beginBulk(int len)
+{
+  if (len > 0 && mSession != nullptr)
+  {
+    mBulkSession = mSession;
+    mBulkLen  = len;
+    mBulkPos  = 0;
+    mBulkTime = millis();
+
+    if (len <= BULK_MAX)
+      mBulk.reset(new byte[len]);
+    else // not clamped, it wouldn't match any snapshot, & its bytes are skipped not to be read as cmds
+    {
+      mBulk.reset();
+      _log << "Bulk cfg of " << len << " Bytes rejected, max is " << BULK_MAX << endl;
+    }
+  }
+}
+
+// the whole cfg is applied at once, never between two frames
+void AllObj::readBulk(Stream& stream, TrackChange trackChange)
+{
+  size_t n = min(size_t(stream.available()), mBulkLen - mBulkPos);
+  if (mBulk)
+    mBulkPos += stream.readBytes(mBulk.get() + mBulkPos, n);
+  else
+    for (; n; n--, mBulkPos++) stream.read(); // skipped
+  mBulkTime = millis(); // still receiving
+
+  if (mBulkPos == mBulkLen)
+  {
+    bool ok = mBulk && restore(mBulk.get(), mBulkLen, trackChange);
+    if (ok) setChanged(); // for the autosave
+
+    if (mBulk) _log << "Bulk cfg of " << mBulkLen << " Bytes " << (ok ? "applied" : "rejected") << endl;
+    stream << SpaceIt(CMD_BULK_DONE, ok) << endl;
+    mBulk.reset();
+    mBulkSession = nullptr;
+  }
+}
+
+void AllObj::sendBulk(Stream& stream)
+{
+  size_t len;
+  SnapshotPtr blob = snapshot(SnapFilter::shown, len);
+
+  if (blob)
+  {
+    stream << SpaceIt(CMD_BULK, len) << endl;
+    stream.write(blob.get(), len);
+  }
+}
+
+//----------------
+void AllObj::beginTransaction()
+{
+  // a previous commit not applied yet is kept for the next frame
+  mInTransaction = true;
+  mTransSession = mSession;
+  mNStaged = mNCommitted;
+  mBeginTime = millis();
+}
+
+void AllObj::commitTransaction()
+{
+  if (mInTransaction)
+  {
+    mInTransaction = false;
+    mNCommitted = mNStaged;
+  }
+}
+
+int AllObj::findStaged(MyVar* var, byte from, byte to)
+{
+  for (byte i = from; i < to; i++)
+    if (mStaged[i].var == var)
+      return i;
+  
+  return -1;
+}
+
+// staged after from, the last set of a var wins
+void AllObj::stageSet(MyVar* var, const Args& args, byte nbArg, TrackChange trackChange, Session* session, byte from)
+{
+  int found = findStaged(var, from, mNStaged);
+  byte i = found >= 0 ? found : mNStaged;
+
+  if (i < TRANS_MAX)
+  {
+    StagedSet& staged = mStaged[i];
+    staged.var = var;
+    staged.nbArg = nbArg;
+    memcpy(staged.args, args, sizeof(Args));
+    staged.trackChange = trackChange;
+    staged.session = session;
+    
+    if (i == mNStaged) mNStaged++;
+  }
+  else
+    dropTransaction("too long");
+}
+
+void AllObj::dropTransaction(const char* reason)
+{
+  _log << "Transaction " << reason << ", " << mNStaged - mNCommitted << " vars dropped" << endl;
+  mInTransaction = false;
+  mNStaged = mNCommitted; // not those already committed
+}
+
+void AllObj::applyTransaction()
+{
+  if (mNCommitted)
+  {
+    for (byte i=0; i < mNCommitted; i++)
+    {
+      StagedSet& staged = mStaged[i];
+      setVar(staged.var, staged.args, staged.nbArg, staged.trackChange, staged.session);
     }
+    setChanged();
+
+    // those of a transaction not committed yet are kept
+    mNStaged -= mNCommitted;
+    memmove(mStaged, mStaged + mNCommitted, mNStaged * sizeof(StagedSet));
+    mNCommitted = 0;
   }
 }
 
@@ -215,30 +465,400 @@ void AllObj::CmdAllVars(Stream& stream, const char* cmdKeyword, TrackChange trac
     {
       if(test == nullptr || (var->*test)())
       {
-        // write a cmd in mTmpBuf
-        snprintf(mTmpBuf.getBuf(), mTmpBuf.getLen(), "%s %s %s", cmdKeyword, objName, var->getName()); 
+        // lex a cmd in mTmpLexer
+        char txt[LEX_WORDS];
+        snprintf(txt, sizeof(txt), "%s %s %s", cmdKeyword, objName, var->getName()); 
+        mTmpLexer.parse(txt);
         // send the result of the cmd to the stream
-        handleCmd(stream, mTmpBuf, trackChange, decode); 
+        handleCmd(stream, mTmpLexer, trackChange, decode); 
       }
     }
   }
-  mTmpBuf.clear(); 
+  mTmpLexer.clear(); 
 }
 
 //----------------
-void AllObj::load(CfgType cfgtype, TrackChange trackChange)
+bool AllObj::loadBinary(CfgType cfgtype, TrackChange trackChange)
 {
-  FileObjPtr cfg = getCfgFile(cfgtype, FileMode::load);
+  bool ok = false;
+  FileObjPtr cfg = getCfgFile(cfgtype, FileMode::load, CfgFormat::binary);
+  
+  if (cfg && cfg->ok())
+  {
+    // the whole file in a single read, then applied at once
+    size_t len = cfg->size();
+    SnapshotPtr blob(new byte[len]);
+    ok = cfg->read(blob.get(), len) == len && restore(blob.get(), len, trackChange);
+  }
+  return ok;
+}
+
+void AllObj::loadText(CfgType cfgtype, TrackChange trackChange)
+{
+  FileObjPtr cfg = getCfgFile(cfgtype, FileMode::load, CfgFormat::text);
   if (cfg && cfg->ok())
     // should be a succession of set cmd
-    readCmd(cfg->getStream(), mTmpBuf, trackChange, Decode::undefined); 
+    readCmd(cfg->getStream(), mTmpLexer, trackChange, Decode::undefined); 
+}
+
+void AllObj::load(CfgType cfgtype, TrackChange trackChange, CfgFormat format)
+{
+  ulong start = micros();
+  
+  bool binary = format == CfgFormat::binary && loadBinary(cfgtype, trackChange);
+  if (!binary) 
+    loadText(cfgtype, trackChange); // fallback if the binary is missing or doesn't match the vars anymore
+
+  mChanged = false;
+
+  _log << (binary ? "Binary" : "Text") << " cfg loaded in " << micros() - start << "µs" << endl;
 }
 
 //----------------
+// serialized in RAM, then written by the save task only if the files have changed
 void AllObj::save(CfgType cfgtype)
 {
-  FileObjPtr cfg = getCfgFile(cfgtype, FileMode::save);
-  if (cfg && cfg->ok())
-    // for all vars, send a get cmd & output the result in the file stream
-    CmdAllVars(cfg->getStream(), CMD_GET, TrackChange::undefined, Decode::verbose); 
+  // binary for a fast load
+  size_t len;
+  SnapshotPtr blob = snapshot(SnapFilter::all, len);
+  if (blob)
+    saveCfgFileAsync(cfgtype, CfgFormat::binary, std::move(blob), len);
+
+  // text for import/export & as a fallback
+  StreamString txt;
+  // for all vars, send a get cmd & output the result in txt
+  CmdAllVars(txt, CMD_GET, TrackChange::undefined, Decode::verbose); 
+  
+  len = txt.length();
+  SnapshotPtr txtBuf(new byte[len]);
+  memcpy(txtBuf.get(), txt.c_str(), len);
+  saveCfgFileAsync(cfgtype, CfgFormat::text, std::move(txtBuf), len);
+
+  mChanged = false;
+}
+
+//----------------
+void AllObj::update()
+{
+  if (mInTransaction && millis() - mBeginTime > TRANS_TIMEOUT)
+    dropTransaction("not committed");
+
+  if (mAutoSave && mChanged && millis() - mChangeTime > AUTOSAVE_WAIT)
+    save(CfgType::Current);
+}
+
+//--------------------------------------
+bool AllObj::inSnapshot(OBJVar* obj, MyVar* var, SnapFilter filter)
+{
+  if (var->getNbArgs() == 0) 
+    return false;
+
+  switch (filter)
+  {
+    case SnapFilter::all:    return true;
+    case SnapFilter::preset: return var->isShown() && obj->isInPreset();
+    default:                 return var->isShown();
+  }
+}
+
+//----------------
+void AllObj::hashVar(CRC32& crc, MyVar* var)
+{
+  const char* varName = var->getName();
+  crc.update(varName, strlen(varName) + 1); // '\0' as a separator
+
+  int min, max;
+  var->getRange(min, max);
+  crc.update(var->getID()); crc.update(var->getNbArgs()); crc.update(min); crc.update(max);
+}
+
+//----------------
+// hash of all that defines the layout of a snapshot
+uint32_t AllObj::getSchema(SnapFilter filter)
+{
+  CRC32 crc;
+  crc.update(filter);
+
+  for (auto obj : *this)
+  {
+    const char* objName = obj->getName();
+    crc.update(objName, strlen(objName) + 1); // '\0' as a separator
+
+    for (auto var : *obj)
+    {
+      if (inSnapshot(obj, var, filter))
+        hashVar(crc, var);
+    }
+  }
+  return crc.finalize();
+}
+
+//----------------
+// hash of all that's sent by the inits but the values
+uint32_t AllObj::getDigest()
+{
+  CRC32 crc;
+
+  for (auto obj : *this)
+  {
+    const char* objName = obj->getName();
+    crc.update(objName, strlen(objName) + 1);
+
+    for (auto var : *obj)
+      if (var->isShown())
+        hashVar(crc, var);
+  }
+  return crc.finalize();
+}
+
+//----------------
+size_t AllObj::getSnapshotSize(SnapFilter filter)
+{
+  size_t size = sizeof(SnapHeader);
+
+  for (auto obj : *this)
+    for (auto var : *obj)
+      if (inSnapshot(obj, var, filter))
+        size += var->getNbArgs() * var->getSize();
+
+  return size;
+}
+
+//----------------
+// write all the vars values in blob
+bool AllObj::snapshot(byte* blob, size_t len, SnapFilter filter)
+{
+  if (blob == nullptr || len != getSnapshotSize(filter)) 
+    return false;
+
+  byte* values = blob + sizeof(SnapHeader);
+  byte* p = values;
+
+  for (auto obj : *this)
+  {
+    for (auto var : *obj)
+    {
+      if (inSnapshot(obj, var, filter))
+      {
+        int min, max;
+        var->getRange(min, max);
+
+        Args args;
+        byte nbArg = var->get(args);
+
+        for (byte i=0; i < var->getNbArgs(); i++)
+          packValue(p, constrain(i < nbArg ? args[i] : 0, min, max), var->getSize());
+      }
+    }
+  }
+
+  SnapHeader* header = (SnapHeader*) blob;
+  header->magic   = SNAP_MAGIC;
+  header->version = SNAP_VERSION;
+  header->filter  = filter;
+  header->schema  = getSchema(filter);
+  header->size    = p - values;
+  header->crc     = CRC32::calculate(values, header->size);
+  
+  return true;
+}
+
+SnapshotPtr AllObj::snapshot(SnapFilter filter, size_t& len)
+{
+  len = getSnapshotSize(filter);
+  SnapshotPtr blob(new byte[len]);
+
+  if (!snapshot(blob.get(), len, filter)) 
+    blob.reset();
+
+  return blob;
+}
+
+//----------------
+// does blob match the current schema ?
+bool AllObj::isValid(const byte* blob, size_t len)
+{
+  if (blob == nullptr || len < sizeof(SnapHeader))
+    return false;
+
+  const SnapHeader* header = (const SnapHeader*) blob;
+  const byte* values = blob + sizeof(SnapHeader);
+  SnapFilter filter = header->filter;
+
+  return header->magic == SNAP_MAGIC && header->version == SNAP_VERSION 
+         && header->size == len - sizeof(SnapHeader) && len == getSnapshotSize(filter)
+         && header->schema == getSchema(filter) && header->crc == CRC32::calculate(values, header->size);
+}
+
+//----------------
+// set the vars values from the blob from, or between from & to with ratio if to is not null
+void AllObj::applySnapshot(const byte* from, const byte* to, uint16_t ratio, TrackChange trackChange)
+{
+  SnapFilter filter = ((const SnapHeader*) from)->filter;
+  const byte* p = from + sizeof(SnapHeader);
+  const byte* q = to != nullptr ? to + sizeof(SnapHeader) : nullptr;
+
+  for (auto obj : *this)
+  {
+    for (auto var : *obj)
+    {
+      if (inSnapshot(obj, var, filter))
+      {
+        int min, max;
+        var->getRange(min, max);
+
+        Args args;
+        for (byte i=0; i < var->getNbArgs(); i++)
+        {
+          int v = unpackValue(p, var->getSize(), var->isSigned());
+          if (q != nullptr)
+          {
+            int vto = unpackValue(q, var->getSize(), var->isSigned());
+            v += (int64_t(vto - v) * ratio + 0x8000) >> 16; // rounded, a bool switches halfway
+          }
+          args[i] = constrain(v, min, max);
+        }
+
+        setVar(var, args, var->getNbArgs(), trackChange, mSession); // not sent back to the session of a bulk cfg
+      }
+    }
+  }
+}
+
+//----------------
+// set all the vars values from blob, only if it matches the current schema
+bool AllObj::restore(const byte* blob, size_t len, TrackChange trackChange)
+{
+  bool ok = isValid(blob, len);
+  if (ok)
+    applySnapshot(blob, nullptr, 0, trackChange);
+
+  return ok;
+}
+
+// ratio is a fract16 from 0 (from) to 65535 (almost to)
+void AllObj::restoreLerp(const byte* from, const byte* to, uint16_t ratio, TrackChange trackChange)
+{
+  applySnapshot(from, to, ratio, trackChange);
+}
+
+//----------------
+void AllObj::touch(SnapFilter filter)
+{
+  for (auto obj : *this)
+    for (auto var : *obj)
+      if (inSnapshot(obj, var, filter))
+        var->touch();
+}
+
+//--------------------------------------
+// reads a text again & again, counts what's written without keeping it
+class BenchStream : public Stream
+{
+  const char* mTxt;
+  size_t      mLen;
+  size_t      mPos     = 0;
+  size_t      mWritten = 0;
+
+public:
+  BenchStream(const char* txt = "", size_t len = 0) : mTxt(txt), mLen(len) {};
+  void   rewind()  { mPos = 0; };
+  size_t written() { return mWritten; };
+
+  // Print
+  size_t write(uint8_t c)                      { mWritten++; return 1; };
+  size_t write(const uint8_t* buf, size_t len) { mWritten += len; return len; };
+
+  // Stream
+  int  available() { return mLen - mPos; };
+  int  peek()      { return mPos < mLen ? mTxt[mPos] : -1; };
+  int  read()      { return mPos < mLen ? mTxt[mPos++] : -1; };
+  void flush()     {};
+};
+
+static void logBench(const char* name, size_t ops, size_t bytes, ulong us)
+{
+  _log << "bench," << name << "," << ops << "," << bytes << "," << us << "," << (ops ? us * 1000 / ops : 0) << endl;
+}
+
+// the vars are set to their own values, nothing changes for the sessions
+void AllObj::bench()
+{
+  bool  changed    = mChanged;
+  ulong changeTime = mChangeTime;
+  size_t ops = 0;
+  ulong start, us;
+  _log << "bench,name,ops,bytes,us,ns/op" << endl;
+
+  // -- obj & var names lookup
+  start = micros();
+  for (byte i = 0; i < BENCH_LOOPS; i++)
+    for (auto obj : *this)
+    {
+      ops += getObjFromName(obj->getName()) == obj;
+      for (auto var : *obj)
+        ops += obj->getVarFromName(var->getName()) == var;
+    }
+  logBench("lookup", ops, 0, micros() - start);
+
+  // -- set & get dispatch of already lexed cmds
+  Lexer lexer;
+  BenchStream out;
+  size_t nSet = 0, nGet = 0;
+  ulong usSet = 0, usGet = 0;
+
+  for (auto obj : *this)
+    for (auto var : *obj)
+    {
+      Args args;
+      byte nbArg = var->get(args);
+      if (nbArg == 0) continue; // a pure cmd
+
+      char txt[LEX_WORDS];
+      int len = snprintf(txt, sizeof(txt), "%s %s %s", CMD_SET, obj->getName(), var->getName());
+      for (byte i = 0; i < nbArg && len < int(sizeof(txt)); i++)
+        len += snprintf(txt + len, sizeof(txt) - len, " %d", args[i]);
+
+      lexer.parse(txt);
+      start = micros();
+      for (byte i = 0; i < BENCH_LOOPS; i++)
+        handleCmd(out, lexer, TrackChange::yes, Decode::verbose);
+      usSet += micros() - start;
+      nSet += BENCH_LOOPS;
+
+      snprintf(txt, sizeof(txt), "%s %s %s", CMD_GET, obj->getName(), var->getName());
+      lexer.parse(txt);
+      start = micros();
+      for (byte i = 0; i < BENCH_LOOPS; i++)
+        handleCmd(out, lexer, TrackChange::undefined, Decode::verbose);
+      usGet += micros() - start;
+      nGet += BENCH_LOOPS;
+    }
+  logBench("set", nSet, 0, usSet);
+  logBench("get", nGet, out.written() / max(nGet, size_t(1)), usGet);
+
+  // -- text save of all the vars
+  BenchStream save;
+  start = micros();
+  for (byte i = 0; i < BENCH_LOOPS; i++)
+    CmdAllVars(save, CMD_GET, TrackChange::undefined, Decode::verbose);
+  logBench("save", BENCH_LOOPS, save.written() / BENCH_LOOPS, micros() - start);
+
+  // -- the saved text read back as set cmds
+  StreamString txt;
+  CmdAllVars(txt, CMD_GET, TrackChange::undefined, Decode::verbose);
+  BenchStream cmds(txt.c_str(), txt.length());
+  lexer.clear();
+  start = micros();
+  for (byte i = 0; i < BENCH_LOOPS; i++)
+  {
+    cmds.rewind();
+    readCmd(cmds, lexer, TrackChange::yes, Decode::undefined);
+  }
+  us = micros() - start;
+  logBench("readCmd", BENCH_LOOPS, txt.length(), us);
+  _log << "readCmd " << (us ? txt.length() * BENCH_LOOPS * 1000 / us : 0) << "KB/s" << endl;
+
+  mChanged    = changed;
+  mChangeTime = changeTime;
 }
@@ -1,44 +1,69 @@
 #include <AllObjBT.h>
 
 //----------------
-void AllObjBT::sendInits(BlueTooth &BT)
+void AllObjBT::sendInits()
 {
-  if(BT.isReady())
+  Transport* transport = getTransport();
+  if(transport != nullptr)
   {
-    BluetoothSerial& BTserial = BT.getSerial();
+    Stream& stream = transport->getStream();
 
-    // for all vars, send an init cmd and output the result in BTSerial (a list of init of vars)
-    CmdAllVars(BTserial, CMD_INIT, TrackChange::undefined, Decode::undefined, &MyVar::isShown); 
+    // for all vars, send an init cmd and output the result in the stream (a list of init of vars)
+    CmdAllVars(stream, CMD_INIT, TrackChange::undefined, Decode::undefined, &MyVar::isShown); 
+    syncSession();
+
+    // for the phone to cache the inits
+    stream << SpaceIt(CMD_DIGEST, int(getDigest())) << endl;
 
     // end of inits
-    BTserial << CMD_INIT_DONE << endl;
+    stream << CMD_INIT_DONE << endl;
   }
 }
 
 //----------------
-void AllObjBT::sendUpdate(BlueTooth &BT, MPU& mpu)
+void AllObjBT::sendInits(int digest)
 {
-  if(BT.isReady())
+  Transport* transport = getTransport();
+  if(transport != nullptr)
   {
-    BluetoothSerial& BTserial = BT.getSerial();
-
-    // for all vars, send a get cmd and output the result in BTSerial (a list of set of changed vars)
-    CmdAllVars(BTserial, CMD_GET, TrackChange::undefined, Decode::compact, &MyVar::hasChanged); 
+    if (uint32_t(digest) == getDigest())
+    {
+      Stream& stream = transport->getStream();
 
-    // send mpu update 
-    SensorOutput& m = mpu.mOutput;
-    if(m.updated)
-      BTserial << SpaceIt(CMD_MPU_UPDATE, m.axis.x, m.axis.y, m.axis.z, m.angle, m.acc, m.w) << endl;
+      // the phone already has the names, IDs & ranges, only send the values
+      CmdAllVars(stream, CMD_GET, TrackChange::undefined, Decode::compact, &MyVar::isShown); 
+      syncSession();
+      stream << CMD_INIT_DONE << endl;
+    }
+    else
+      sendInits(); // the vars have changed
   }
 }
 
 //----------------
-void AllObjBT::receiveUpdate(BlueTooth &BT)
+void AllObjBT::sendBulk()
 {
-  if (BT.isReady())
+  Transport* transport = getTransport();
+  if(transport != nullptr)
+    AllObj::sendBulk(transport->getStream());
+}
+
+//----------------
+void AllObjBT::sendUpdate(MPU& mpu)
+{
+  Transport* transport = getTransport();
+  if(transport != nullptr)
   {
-    // should receive a list of set cmd 
-    // DO NOT track change or what's received would echoed in sendUpdate
-    readCmd(BT.getSerial(), mBTbuf, TrackChange::no, Decode::undefined); // there's nothing to decode set cmd @the moment
+    // for all vars, send a get cmd and output the result in the stream (a list of set of changed vars)
+    sendChanges(transport->getStream()); 
+
+    // send mpu update, only the latest one matters
+    SensorOutput& m = mpu.mOutput;
+    if(m.updated)
+    {
+      char txt[TELEMETRY_MAX];
+      int len = snprintf(txt, sizeof(txt), "%c %d %d %d %d %d %d\n", CMD_MPU_UPDATE, m.axis.x, m.axis.y, m.axis.z, m.angle, m.acc, m.w);
+      transport->sendTelemetry(txt, min(len, int(sizeof(txt)) - 1));
+    }
   }
 }
@@ -0,0 +1,29 @@
+#include <CmdServer.h>
+
+// --------------
+void CmdServer::begin()
+{
+  mServer.begin();
+  _log << "Cmd server, answer @ " << WiFi.localIP() << ":" << CMD_PORT << endl;
+
+  mHasBegun = true;
+}
+
+// --------------
+bool CmdServer::update()
+{
+  if (!mHasBegun) begin();
+  
+  mConnected = mClient.connected();
+
+  if (!mConnected)
+    mClient = mServer.accept();
+
+  if (mConnected != mWasConnected)
+  {
+    mWasConnected = mConnected;
+    _log << "Cmd client " << (mConnected ? "connected" : "disconnected") << endl;
+  }
+
+  return mConnected;
+}
@@ -16,25 +16,165 @@ void CfgFiles::init()
 
   if (spiffsOK)
   {
+    // finish or discard any save interrupted by a power cut
+    for (auto path : { CFG_CURRENT, CFG_DEFAULT, CFG_CURRENT_BIN, CFG_DEFAULT_BIN, CFG_PRESETS }) 
+      recover(path);
+
     File root = SPIFFS.open("/");
     while(File file = root.openNextFile())
       _log << "File " << file.name() << " - " << file.size() << " Bytes" << endl;
+
+    mSaveQueue = xQueueCreate(SAVE_QUEUE, sizeof(SaveJob));
+    if (xTaskCreatePinnedToCore(saveTask, "saveTask", SAVE_STACK, this, SAVE_PRIO, nullptr, SAVE_CORE) == pdPASS)
+      _log << "Cfg saved on Core " << SAVE_CORE << " with Prio " << SAVE_PRIO << endl;
+    else
+    {
+      vQueueDelete(mSaveQueue);
+      mSaveQueue = nullptr; // saved by the caller
+      _log << "Cfg save task FAILED, saved in the loop" << endl;
+    }
+  }
+}
+
+//-----------------
+void CfgFiles::saveTask(void* _cfgFiles)
+{
+  CfgFiles* cfgFiles = (CfgFiles*) _cfgFiles;
+  SaveJob   job;
+
+  for (;;) // forever
+  {
+    if (xQueueReceive(cfgFiles->mSaveQueue, &job, portMAX_DELAY) == pdTRUE)
+    {
+      cfgFiles->saveFile(job.path, job.buf, job.len);
+      delete[] job.buf;
+    }
   }
 }
 
 //-----------------
-FileObjPtr CfgFiles::getCfgFile(CfgType cfgtype, FileMode mode) 
+const char* CfgFiles::getPath(CfgType cfgtype, CfgFormat format)
+{
+  if (format == CfgFormat::binary)
+    return cfgtype == CfgType::Default ? CFG_DEFAULT_BIN : CFG_CURRENT_BIN;
+  else
+    return cfgtype == CfgType::Default ? CFG_DEFAULT : CFG_CURRENT;
+}
+
+void CfgFiles::getTmpPath(const char* path, char* tmp, size_t len)
+{
+  snprintf(tmp, len, "%s%c", path, CFG_TMP_EXT);
+}
+
+FileObjPtr CfgFiles::getFile(const char* path, FileMode mode) 
+{
+  return FileObjPtr( spiffsOK ? new FileObj(path, mode, mNVS, mFsMutex) : nullptr ); 
+}
+
+FileObjPtr CfgFiles::getCfgFile(CfgType cfgtype, FileMode mode, CfgFormat format) 
+{
+  return getFile(getPath(cfgtype, format), mode); 
+}
+
+//-----------------
+// write buf in the file only if its content has changed
+void CfgFiles::saveFile(const char* path, const byte* buf, size_t len)
 {
-  const char* path = cfgtype == CfgType::Default ? CFG_DEFAULT : CFG_CURRENT;
-  return FileObjPtr( spiffsOK ? new FileObj(path, mode, mNVS) : nullptr ); 
+  if (spiffsOK)
+  {
+    FsLock      lock(mFsMutex);
+    uint32_t    crc = CRC32::calculate(buf, len);
+    uint32_t    oldcrc;
+
+    _log << "Saving  " << path;
+
+    if (mNVS.isOK() && mNVS.getuint(path, oldcrc) && crc == oldcrc && SPIFFS.exists(path))
+      _log << "...unchanged";
+    else
+      writeAtomic(path, buf, len, crc);
+
+    _log << endl;
+  }
+}
+
+//-----------------
+// serialized by the caller, written by the save task
+void CfgFiles::saveFileAsync(const char* path, SnapshotPtr buf, size_t len)
+{
+  SaveJob job = { path, buf.get(), len };
+
+  if (mSaveQueue != nullptr && xQueueSend(mSaveQueue, &job, 0) == pdTRUE)
+    buf.release(); // the save task deletes it
+  else
+    saveFile(path, buf.get(), len); // blocking if the queue is full
+}
+
+void CfgFiles::saveCfgFileAsync(CfgType cfgtype, CfgFormat format, SnapshotPtr buf, size_t len)
+{
+  saveFileAsync(getPath(cfgtype, format), std::move(buf), len);
+}
+
+//-----------------
+// write a tmp file then rename it, so that a power cut never leaves a partial cfg file
+bool CfgFiles::writeAtomic(const char* path, const byte* buf, size_t len, uint32_t crc)
+{
+  char tmp[32];
+  getTmpPath(path, tmp, sizeof(tmp));
+
+  File f = SPIFFS.open(tmp, "w");
+  bool ok = f && f.write(buf, len) == len;
+  if (f) f.close();
+
+  // the crc is set before the rename, recover() uses it to know if the tmp file is complete
+  if (logTst(ok, "write", "ok", "failed") && logTst(mNVS.setuint(path, crc), "set crc", "ok", "failed"))
+  {
+    SPIFFS.remove(path);
+    ok = logTst(SPIFFS.rename(tmp, path), "rename", "ok", "failed");
+  }
+  else
+  {
+    SPIFFS.remove(tmp);
+    ok = false;
+  }
+  return ok;
+}
+
+//-----------------
+// a tmp file left by writeAtomic replaces the cfg file only if it's complete
+void CfgFiles::recover(const char* path)
+{
+  char tmp[32];
+  getTmpPath(path, tmp, sizeof(tmp));
+
+  if (SPIFFS.exists(tmp))
+  {
+    File f = SPIFFS.open(tmp, "r");
+    CRCStream stream(f);
+    stream.readAll();
+    f.close();
+
+    uint32_t crc;
+    _log << "Recover " << path;
+    
+    if (logTst(mNVS.getuint(path, crc) && crc == stream.getCRC(), "tmp file", "complete", "partial"))
+    {
+      SPIFFS.remove(path);
+      logTst(SPIFFS.rename(tmp, path), "rename", "ok", "failed");
+    }
+    else
+      logTst(SPIFFS.remove(tmp), "delete", "ok", "failed");
+
+    _log << endl;
+  }
 }
 
 //--------------------------------------------------------------------------
-FileObj::FileObj(const char* path, FileMode mode, MyNvs& nvs) : isloading(mode == FileMode::load), mNVS(nvs)
+FileObj::FileObj(const char* path, FileMode mode, MyNvs& nvs, SemaphoreHandle_t fsMutex) 
+: mLock(fsMutex), isloading(mode == FileMode::load), mNVS(nvs)
 {
   if (!isloading || SPIFFS.exists(path)) // might not exists if saving
   {
-    f = SPIFFS.open(path, isloading ? "r" : "w+"); // need to be readable to compute crc
+    f = SPIFFS.open(path, isloading ? "r" : "w");
     if (f)
     {
       _log << (isloading ? "Loading " : "Saving  ") << path << "...";
@@ -73,21 +213,13 @@ void FileObj::remove()
   }
 }
 
-//----------------
-uint32_t FileObj::getCRC()
-{
-  f.flush();
-  f.seek(0, SeekMode::SeekSet);
-  
-  CRC32 crc;
-  for (size_t i = 0; i < f.size(); i++) crc.update(f.read()); 
-  return crc.finalize();
-}
-
 //----------------
 void FileObj::handleCRC()
 {
-  uint32_t crc = getCRC();
+  if (isloading)
+    mStream.readAll(); // if not already read
+  
+  uint32_t crc = mStream.getCRC();
 
   if (isloading)
   {
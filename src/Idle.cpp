@@ -0,0 +1,84 @@
+#include <Idle.h>
+
+//--------------------------------------
+void IdleMode::init()
+{
+  setInPreset(false);
+  mActiveMhz = getCpuFrequencyMhz();
+  mSince = millis();
+
+  AddVarCode("auto",    setAuto(args[0]), mAuto, false, 0, 1) // park on the idle motion event, opt-in
+  AddVarName("ledTick", mLedTick, IDLE_LED_TICK, 10, 1000)
+  AddVarName("cpuMhz",  mCpuMhz,  IDLE_CPU_MHZ,  80, 240)   // 80, 160 or 240
+  AddVarName("preset",  mPreset,  IDLE_PRESET,   -1, PRESET_N - 1)
+  AddCmdArgHid("park",  park(args[0]), 0, 1)
+  AddCmdHid("stats",    showStats())
+}
+
+//--------------------------------------
+void IdleMode::setAuto(bool on)
+{
+  mAuto = on;
+  if (!on) park(false);
+}
+
+void IdleMode::onMotion(MotionEvent event)
+{
+  if (event == MotionEvent::idle)
+  {
+    if (mAuto) park(true);
+  }
+  else
+    park(false); // any motion wakes up
+}
+
+//----------------
+void IdleMode::park(bool on)
+{
+  Power power = on ? Power::idle : Power::active;
+  if (power == mPower) return;
+
+  ulong now = millis();
+  mStats[int(mPower)].time += now - mSince;
+  mSince = now;
+  mPower = power;
+
+  uint32_t mhz = on ? mCpuMhz : mActiveMhz;
+  if (!setCpuFrequencyMhz(mhz))
+    _log << "Idle can't set the cpu @ " << mhz << "MHz" << endl;
+
+  if (mPreset >= 0 || !on) // unpark even if the preset has been unset meanwhile
+    on ? mPresets.park(mPreset) : mPresets.unpark();
+
+  _log << "Idle " << POWER_NAMES[int(power)] << " - cpu @ " << getCpuFrequencyMhz() << "MHz" << endl;
+}
+
+//--------------------------------------
+void IdleMode::endLoop()
+{
+  LoopStats& stats = mStats[int(mPower)];
+  ulong busy = micros() - mLoopBegin;
+  stats.n++;
+  stats.busy += busy;
+  stats.max = max(stats.max, busy);
+
+  if (isIdle()) delay(IDLE_LOOP_WAIT);
+}
+
+// the busy ratio goes with the current drawn, to be measured on the battery line
+void IdleMode::showStats()
+{
+  for (byte i = 0; i < int(Power::count); i++)
+  {
+    const LoopStats& stats = mStats[i];
+    ulong time = stats.time + (i == int(mPower) ? millis() - mSince : 0);
+    
+    _log << "Idle " << POWER_NAMES[i] << " " << time / 1000 << "s - " << stats.n << " loops";
+    if (stats.n && time)
+    {
+      _log << " - " << ulong(uint64_t(stats.n) * 1000 / time) << " loops/s - " << ulong(stats.busy / stats.n) << "µs avg - " << stats.max << "µs max";
+      _log << " - " << ulong(stats.busy / (10 * time)) << "% busy";
+    }
+    _log << endl;
+  }
+}
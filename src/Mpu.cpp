@@ -9,42 +9,105 @@
 
 //--------------------------------------
 #ifdef MPU_GET_CORE
-  SemaphoreHandle_t   OutputMutex = xSemaphoreCreateMutex();
-  EventGroupHandle_t  FlagReady = xEventGroupCreate();
-  TaskHandle_t        NotifyToCalibrate;
-  SensorOutput        SharedOutput; // shared with update so that the mutex is barely taken by MPUComputeTask
+  TaskHandle_t               NotifyToCalibrate;
+  TripleBuffer<SensorOutput> SharedOutput; // the task computes in the back buffer, update gets the newest sample without waiting
 
   void MPUComputeTask(void* _mpu)
   {
     MPU*          mpu = (MPU*) _mpu;
-    SensorOutput  taskOutput; //output to store computation
     TickType_t    lastWakeTime = xTaskGetTickCount();
 
     for (;;) // forever
     {
-      if(mpu->getFiFoPacket())
+      if (mpu->bringUp()) // begin off the loop
       {
-        mpu->compute(taskOutput);
+        #ifdef MPU_DRAIN_FIFO
+          while(mpu->getFiFoPacket()) // every sample is smoothed, the loop gets the newest one
+        #else
+          if(mpu->getFiFoPacket())
+        #endif
+        {
+          mpu->compute(SharedOutput.back());
+          SharedOutput.publish();
+
+          if(ulTaskNotifyTake(pdTRUE, 0)) // pool the the task semaphore
+            mpu->calibrate();
+        }
+
+        mpu->checkReplay(); // not while compute runs
+      }
 
-        xSemaphoreTake(OutputMutex, portMAX_DELAY);
-        memcpy(&SharedOutput, &taskOutput, sizeof(SensorOutput)); 
-        xSemaphoreGive(OutputMutex);
+      // should got a packet every MPU_TASK_PERIOD
+      vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(MPU_TASK_PERIOD)); 
+    }
+  }
+#endif
 
-        xEventGroupSetBits(FlagReady, 1);
+//--------------------------------------
+inline uint16_t getSmooth(ulong dt) { return - int(pow(1. - ACCEL_AVG, dt * ACCEL_BASE_FREQ * .000001) * 65536.); } // 1 - (1-accel_avg) ^ (dt * 60 / 1000 000) using fract16
 
-        if(ulTaskNotifyTake(pdTRUE, 0)) // pool the the task semaphore
-          mpu->calibrate();
-      }
+#ifdef MPU_FIXED_MATH
+  #define ANGLE_PI         1998  // angle unit = 2 * 318 / rad
+  #define ANGLE_HALF_PI    999
+  #define ASIN_SHIFT       7     // Q14 between the asin LUT entries
+  #define ASIN_MAX         11586 // Q14 sin(PI/4), asin gets too steep beyond
+  #define SMOOTH_SHIFT     7     // µs between the smooth LUT entries
+  #define SMOOTH_LUT       256   // up to 32ms, the float math beyond
+
+  uint16_t AsinLUT[(ASIN_MAX >> ASIN_SHIFT) + 2]; // angle unit << 4
+  uint16_t SmoothLUT[SMOOTH_LUT + 1];
+
+  void initFixedMath()
+  {
+    for (int i = 0; i < (ASIN_MAX >> ASIN_SHIFT) + 2; i++)
+      AsinLUT[i] = asin((i << ASIN_SHIFT) / 16384.) * 2 * 318. * 16 + .5;
+
+    for (int i = 0; i <= SMOOTH_LUT; i++)
+      SmoothLUT[i] = getSmooth(i << SMOOTH_SHIFT);
+  }
+
+  inline int lerpLUT(const uint16_t* lut, uint32_t x, byte shift)
+  {
+    uint32_t i = x >> shift, f = x & ((1 << shift) - 1);
+    return (lut[i] * ((1 << shift) - f) + lut[i + 1] * f) >> shift;
+  }
+
+  inline uint16_t getSmoothFixed(ulong dt) { return dt < (SMOOTH_LUT << SMOOTH_SHIFT) ? lerpLUT(SmoothLUT, dt, SMOOTH_SHIFT) : getSmooth(dt); }
+  inline int      asinFixed(int x)         { return x >= 0 ? lerpLUT(AsinLUT, x, ASIN_SHIFT) >> 4 : - (lerpLUT(AsinLUT, -x, ASIN_SHIFT) >> 4); }
+
+  // w & s = sqrt(1 - w²) in Q14, the asin LUT is only used where it's flat enough
+  inline int acosFixed(int w, int s)
+  {
+    if (abs(w) <= ASIN_MAX) return ANGLE_HALF_PI - asinFixed(w);
+
+    int a = asinFixed(min(s, ASIN_MAX));
+    return w > 0 ? a : ANGLE_PI - a;
+  }
+
+  inline uint32_t isqrt(uint32_t x)
+  {
+    uint32_t r = 0, b = 1UL << 30;
+    while (b > x) b >>= 2;
 
-      // should got a packet every 10ms
-      vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(10)); 
+    for (; b; b >>= 2)
+    {
+      if (x >= r + b) { x -= r + b; r = (r >> 1) + b; }
+      else r >>= 1;
     }
+    return r;
   }
 #endif
 
 //--------------------------------------
-void MPU::init()
+void MPU::init(AllObj& allObj)
 {
+  setInPreset(false);
+  mAllObj = &allObj;
+
+  #ifdef MPU_FIXED_MATH
+    initFixedMath();
+  #endif
+
   // save calibration
   #define AddOffset(var)     AddVarHid(var, 0, -32768, 32767)
   AddOffset(mXGyroOffset);   AddOffset(mYGyroOffset);  AddOffset(mZGyroOffset);
@@ -62,6 +125,10 @@ void MPU::init()
   #endif
 
   AddBoolName("auto",       mAutoCalibrate, false);
+  AddBoolName("bgCalib",    mBgCalibrate,   false); // learn the gyro offsets when still, saved once settled
+
+  AddCmdArg  ("record",     record(args[0]), 0, 1) // 1 to begin, 0 to save the last measures in MPU_RIDE_FILE
+  AddCmd     ("replay",     mReplayAsked = true)   // MPU_RIDE_FILE with the current tweaks, summed up as csv
 
   AddVarName ("neutralAcc", mNeutralAcc, 60,   0, 300);
   AddVarName ("maxAcc",     mMaxAcc,     2000, 500, 8192);
@@ -81,6 +148,19 @@ void MPU::calibrate()
   mXAccelOffset = getXAccelOffset(); mYAccelOffset = getYAccelOffset(); mZAccelOffset = getZAccelOffset();
   printOffsets(F("MPU calibrated"));
   mGotOffset = true;
+  syncBias();
+}
+
+// not from the loop once the mpu task runs
+void MPU::syncBias()
+{
+  const int16_t offset[3] = { getXGyroOffset(), getYGyroOffset(), getZGyroOffset() };
+  mBias.reset(offset);
+
+  if (!mGotOffset) // the factory accel offsets saved with the learnt gyro ones
+  {
+    mXAccelOffset = getXAccelOffset(); mYAccelOffset = getYAccelOffset(); mZAccelOffset = getZAccelOffset();
+  }
 }
 
 bool MPU::setOffsets()
@@ -107,23 +187,49 @@ void MPU::printOffsets(const __FlashStringHelper* txt)
 }
 
 //--------------------------------------
-void MPU::begin()
+bool MPU::begin()
 { 
-  mHasBegun = true;
   Wire.begin(SDA, SCL, I2C_CLOCK);
 
   initialize(); reset(); resetI2CMaster(); //help with startup reliabilily
 
-  _log << F("MPU connection...") << (testConnection() ? F("successful") : F("failed")) << endl;
+  bool connected = testConnection();
+  _log << F("MPU connection...") << (connected ? F("successful") : F("failed")) << endl;
+  if (!connected) return false;
+
+  #ifdef MPU_SOFT_FUSION
+    // same scales as the dmp, gyro & accel sampled at 1kHz
+    setFullScaleGyroRange(MPU6050_GYRO_FS_2000);
+    setFullScaleAccelRange(MPU6050_ACCEL_FS_2);
+    setDLPFMode(MPU6050_DLPF_BW_188);
+    setRate(0);
+
+    if (mBgCalibrate)
+      setOffsets(); // refined in the background
+    else if(!mAutoCalibrate || !setOffsets())
+      calibrate();
+    syncBias();
+
+    mT = micros();
+    mDmpReady = true;
+    _log << _FMT(F("MPU soft fusion @ %Hz"), MPU_FUSION_RATE) << endl;
+    return true;
+  #endif
+
   uint8_t devStatus = dmpInitialize();
 
   if (devStatus == 0) // did it work ?
   { 
-    if(!mAutoCalibrate || !setOffsets())
+    if (mBgCalibrate)
+      setOffsets(); // refined in the background
+    else if(!mAutoCalibrate || !setOffsets())
       calibrate();
+    syncBias();
 
-    mFifoBuffer = (uint8_t* )malloc(dmpGetFIFOPacketSize() * sizeof(uint8_t)); // FIFO storage buffer
+    mPacketSize = dmpGetFIFOPacketSize();
+    mFifoBuffer = (uint8_t* )malloc(mPacketSize * sizeof(uint8_t)); // FIFO storage buffer
     assert (mFifoBuffer!=nullptr);
+    assert (mPacketSize <= MPU_PACKET_MAX);
 
     setDMPEnabled(true);
     mDmpReady = true;
@@ -133,6 +239,29 @@ void MPU::begin()
     const __FlashStringHelper* error =  devStatus == 1 ? F("initial memory load") : (devStatus == 2 ? F("DMP configuration updates") : F("unknown"));
     _log << _FMT(F("DMP ERROR #% : % failure"), devStatus, error) << endl;
   }
+  return mDmpReady;
+}
+
+// not before the loop has asked for it, so that begin() gets the loaded cfg
+bool MPU::bringUp()
+{
+  if (mReady) return true;
+
+  ulong time = millis();
+  if (!mBeginAsked || mTries == MPU_INIT_TRIES || (mTries && time - mTryTime < MPU_INIT_WAIT)) return false;
+
+  mTries++;
+  mTryTime = time;
+
+  if (begin())
+  {
+    mReady = true;
+    _log << _FMT(F("MPU ready @ %ms after % tries"), millis(), mTries) << endl; // since boot
+  }
+  else if (mTries == MPU_INIT_TRIES)
+    _log << _FMT(F("MPU FAILED % times, off until a reset"), mTries) << endl;
+
+  return mReady;
 }
 
 //--------------------------------------
@@ -153,19 +282,93 @@ void MPU::getAxiSAngle(VectorInt16& v, int& angle, Quaternion& q)
   }
 }
 
+#ifdef MPU_FIXED_MATH
+  void MPU::getAxiSAngle(VectorInt16& v, int& angle, const int16_t* q)
+  {
+    int w = constrain(q[0], -16384, 16384);
+    int s = isqrt(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]); // sin(angle / 2) in Q14
+    angle = acosFixed(w, s);
+
+    if (s < 16) // div 0
+    {
+      v.x = 1; v.y = v.z = 0;
+    }
+    else
+    {
+      v.x = q[1] * 255 / s; v.y = q[2] * 255 / s; v.z = q[3] * 255 / s;
+    }
+  }
+#endif
+
 //--------------------------------------
 bool MPU::getFiFoPacket() 
 { 
-  ulong dt = micros() - mT; // best place to get the actual dt if called right after the delay function
+  #ifdef MPU_SOFT_FUSION
+    if (!mDmpReady) return false;
+
+    getMotion6(&mAcc.x, &mAcc.y, &mAcc.z, &mW.x, &mW.y, &mW.z);
+    ulong t = micros();
+    mdt = t - mT;
+    mT = t;
+    return true;
+
+  #elif defined(MPU_DRAIN_FIFO)
+    if (mDmpReady && !mSamples.available())
+      drainFifo();
 
-  if (mDmpReady && dmpGetCurrentFIFOPacket(mFifoBuffer))
+    MPUSample sample;
+    if (mSamples.pop(sample))
+    {
+      memcpy(mFifoBuffer, sample.packet, mPacketSize);
+      long dt = sample.time - mT;
+      mdt = dt > 0 ? dt : 1000000 / MPU_DMP_RATE; // not before the previous one
+      mT = sample.time;
+      return true;
+    }
+    return false;
+
+  #else
+    ulong dt = micros() - mT; // best place to get the actual dt if called right after the delay function
+
+    if (mDmpReady && dmpGetCurrentFIFOPacket(mFifoBuffer))
+    {
+      mdt = dt;
+      mT += dt;
+      return true; 
+    }
+    return false;
+  #endif
+}
+
+//--------------------------------------
+#ifdef MPU_DRAIN_FIFO
+  // all the packets in the fifo with a single read, the last one has just been written & the others are a dmp period apart
+  void MPU::drainFifo()
   {
-    mdt = dt;
-    mT += dt;
-    return true; 
+    uint16_t count = getFIFOCount();
+    ulong    now   = micros();
+
+    if (count >= MPU_FIFO_SIZE || getIntFIFOBufferOverflowStatus()) // the packets aren't aligned anymore
+    {
+      resetFIFO();
+      mLost += count / mPacketSize;
+      return;
+    }
+
+    size_t n = min(size_t(count / mPacketSize), size_t(min(MPU_BURST_MAX / mPacketSize, MPU_SAMPLES))); // the next ones in the next read
+    if (n == 0) return;
+
+    getFIFOBytes(mBurst, n * mPacketSize);
+
+    MPUSample sample;
+    for (size_t i = 0; i < n; i++)
+    {
+      sample.time = now - (count / mPacketSize - 1 - i) * (1000000 / MPU_DMP_RATE);
+      memcpy(sample.packet, mBurst + i * mPacketSize, mPacketSize);
+      mSamples.push(&sample, 1);
+    }
   }
-  return false;
-}
+#endif
 
 //--------------------------------------
 inline int thresh(int v, uint16_t t) { return v > 0 ? max(0, v - t) : min(v + t, 0); }
@@ -173,31 +376,163 @@ inline int16_t stayshort(int v)      { return constrain(v, -32768, 32767); }
 inline int16_t staybyte(int16_t v)   { return constrain(v, -255, 255); }
 inline void shiftrVector(VectorInt16 &v, byte n) { v.x = v.x >> n; v.y = v.y >> n; v.z = v.z >> n; }
 
+//--------------------------------------
+#ifdef MPU_SOFT_FUSION
+  // Mahony: the gyro integrated in the quaternion, its drift corrected by the error between the measured & the estimated gravity
+  void MPU::fuse()
+  {
+    float& qw = mFusion[0]; float& qx = mFusion[1]; float& qy = mFusion[2]; float& qz = mFusion[3];
+
+    const float toRad = PI / 180. / 16.4; // gyro 2000°/s
+    float gx = mW.x * toRad, gy = mW.y * toRad, gz = mW.z * toRad;
+
+    float ax = mAcc.x, ay = mAcc.y, az = mAcc.z;
+    float norm2 = ax * ax + ay * ay + az * az;
+    if (norm2 > 0)
+    {
+      float n = 1. / sqrtf(norm2);
+      ax *= n; ay *= n; az *= n;
+
+      // estimated gravity, as dmpGetGravity
+      float vx = 2 * (qx * qz - qw * qy);
+      float vy = 2 * (qw * qx + qy * qz);
+      float vz = qw * qw - qx * qx - qy * qy + qz * qz;
+
+      gx += MPU_FUSION_KP * (ay * vz - az * vy);
+      gy += MPU_FUSION_KP * (az * vx - ax * vz);
+      gz += MPU_FUSION_KP * (ax * vy - ay * vx);
+    }
+
+    float h = mdt * .0000005; // dt / 2 in s
+    gx *= h; gy *= h; gz *= h;
+    float w = qw, x = qx, y = qy;
+    qw += -x * gx - y * gy - qz * gz;
+    qx +=  w * gx + y * gz - qz * gy;
+    qy +=  w * gy - x * gz + qz * gx;
+    qz +=  w * gz + x * gy - y * gx;
+
+    float n = 1. / sqrtf(qw * qw + qx * qx + qy * qy + qz * qz);
+    qw *= n; qx *= n; qy *= n; qz *= n;
+
+    #ifdef MPU_FIXED_MATH
+      mQuat[0] = qw * 16384; mQuat[1] = qx * 16384; mQuat[2] = qy * 16384; mQuat[3] = qz * 16384;
+    #else
+      mQuat = Quaternion(qw, qx, qy, qz);
+    #endif
+
+    shiftrVector(mAcc, 1); // 1g = 8192 like the dmp
+  }
+#endif
+
+//--------------------------------------
 void MPU::compute(SensorOutput& output)
 {
-  // measures
-  dmpGetQuaternion(&mQuat, mFifoBuffer);
-  dmpGetGyro(&mW, mFifoBuffer);
-  dmpGetAccel(&mAcc, mFifoBuffer);
+  getMeasures();
+
+  if (mBgCalibrate && mBias.push(mW, mAcc))
+  {
+    const int16_t* offset = mBias.getOffset(); // a few LSB, the next measures already have it
+    setXGyroOffset(offset[0]); setYGyroOffset(offset[1]); setZGyroOffset(offset[2]);
+  }
+
+  if (mRecording)
+  {
+    MPURecord rec;
+    rec.dt = min(mdt, ulong(UINT16_MAX));
+    #ifdef MPU_FIXED_MATH
+      memcpy(rec.quat, mQuat, sizeof(rec.quat));
+    #else
+      rec.quat[0] = mQuat.w * 16384; rec.quat[1] = mQuat.x * 16384; rec.quat[2] = mQuat.y * 16384; rec.quat[3] = mQuat.z * 16384;
+    #endif
+    rec.w[0]   = mW.x;   rec.w[1]   = mW.y;   rec.w[2]   = mW.z;
+    rec.acc[0] = mAcc.x; rec.acc[1] = mAcc.y; rec.acc[2] = mAcc.z;
+    mRideQueue.push(&rec, 1); // lost if the loop is late
+  }
+
+  process(output);
+  output.seq  = ++mSeq;
+  output.time = mT;
+
+  mMotion.push(getMotionSample(output));
+}
+
+//----------------
+MotionSample MPU::getMotionSample(const SensorOutput& output)
+{
+  MotionSample sample;
+  sample.acc  = output.acc;
+  sample.w    = output.w;
+  sample.vert = mAccReal.z;
+  #ifdef MPU_FIXED_MATH
+    sample.tilt = mGrav.z;
+  #else
+    sample.tilt = mGrav.z * 8192;
+  #endif
+  sample.time = output.time;
+  return sample;
+}
+
+//----------------
+void MPU::getMeasures()
+{
+  #ifdef MPU_SOFT_FUSION
+    fuse(); // mW & mAcc already read
+  #else
+    #ifdef MPU_FIXED_MATH
+      dmpGetQuaternion(mQuat, mFifoBuffer);
+    #else
+      dmpGetQuaternion(&mQuat, mFifoBuffer);
+    #endif
+    dmpGetGyro(&mW, mFifoBuffer);
+    dmpGetAccel(&mAcc, mFifoBuffer);
+  #endif
 
-  #ifdef USE_V6_12 
+  #if defined(USE_V6_12) && !defined(MPU_SOFT_FUSION)
     // fix sensibility bug in MPU6050_6Axis_MotionApps_V6_12.h
     shiftrVector(mW, 2) 
     shiftrVector(mAcc, 1) 
   #endif
+}
 
+//----------------
+void MPU::process(SensorOutput& output)
+{
   // gravity & corrected accel
-  dmpGetGravity(&mGrav, &mQuat);
-  dmpGetLinearAccel(&mAccReal, &mAcc, &mGrav); // remove measured grav
+  #ifdef MPU_FIXED_MATH
+    int w = mQuat[0], x = mQuat[1], y = mQuat[2], z = mQuat[3]; // same as dmpGetGravity, Q28 >> 15 gives 1g = 8192
+    mGrav.x = (x * z - w * y) >> 14;
+    mGrav.y = (w * x + y * z) >> 14;
+    mGrav.z = (w * w - x * x - y * y + z * z) >> 15;
+    mAccReal.x = mAcc.x - mGrav.x; mAccReal.y = mAcc.y - mGrav.y; mAccReal.z = mAcc.z - mGrav.z; // remove measured grav
+  #else
+    dmpGetGravity(&mGrav, &mQuat);
+    dmpGetLinearAccel(&mAccReal, &mAcc, &mGrav); // remove measured grav
+  #endif
 
   // smooth acc & gyro
-  uint16_t smooth = - int(pow(1. - ACCEL_AVG, mdt * ACCEL_BASE_FREQ * .000001) * 65536.); // 1 - (1-accel_avg) ^ (dt * 60 / 1000 000) using fract16
+  #ifdef MPU_FIXED_MATH
+    uint16_t smooth = getSmoothFixed(mdt);
+  #else
+    uint16_t smooth = getSmooth(mdt);
+  #endif
   mAccY = lerp15by16(mAccY, stayshort(mAccReal.y),  smooth);
   mWZ   = lerp15by16(mWZ,   stayshort(mW.z * -655), smooth);
 
   // output
   getAxiSAngle(output.axis, output.angle, mQuat);
 
+  #ifdef MPU_CHECK_FIXED
+    Quaternion q(mQuat[0] / 16384., mQuat[1] / 16384., mQuat[2] / 16384., mQuat[3] / 16384.);
+    VectorInt16 axis;
+    int angle;
+    getAxiSAngle(axis, angle, q);
+
+    mMaxAngleErr  = max(mMaxAngleErr,  abs(angle - output.angle));
+    if (abs(angle - ANGLE_PI / 2) < ANGLE_PI / 2 - 20) // the axis is noise near a null rotation
+      mMaxAxisErr = max(mMaxAxisErr, max(abs(axis.x - output.axis.x), max(abs(axis.y - output.axis.y), abs(axis.z - output.axis.z))));
+    mMaxSmoothErr = max(mMaxSmoothErr, abs(int(getSmooth(mdt)) - int(smooth)));
+  #endif
+
   // int16_t acc = stayshort(thresh(mAccY / mDivAcc, mNeutralAcc) << 8);
   // mAccYsmooth = acc * mAccYsmooth < 0 || abs(acc) > abs(mAccYsmooth) ? acc : lerp15by16(mAccYsmooth, acc, mSmoothAcc);
   // output.acc = staybyte(mAccYsmooth >> 7);
@@ -210,6 +545,10 @@ void MPU::compute(SensorOutput& output)
   output.w = staybyte((thresh(mWZ, mNeutralW) << 8) / mMaxW);
   output.updated = true;
 
+  #ifdef MPU_PREDICT
+    getRates(output);
+  #endif
+
   #ifdef MPU_DBG
     _log << "[ dt "         <<    _WIDTH(mdt * .001, 6) << "ms - smooth " <<      _WIDTH(smooth / 65536.,  6) << "] ";
     _log << "[ smooth acc " <<    _WIDTH(acc, 6) << " " << _WIDTH(mAccYsmooth, 6)      << " - smooth w " <<      _WIDTH(mWZ, 6)              << "] ";
@@ -222,20 +561,247 @@ void MPU::compute(SensorOutput& output)
   #endif
 }
 
+//----------------
+// finite differences over the sample dt, smoothed not to extrapolate the noise
+void MPU::getRates(SensorOutput& output)
+{
+  Rates& r = mRates;
+  long dt = max(mdt, 1000UL); // µs, a packet read late comes with a short dt
+
+  if (r.valid)
+  {
+    int dAngle = output.angle - r.angle;
+    if (abs(dAngle) > MPU_ANGLE_2PI / 4) dAngle = 0; // the angle wraps when the quaternion flips
+
+    r.dAngle += (dAngle * 1000000L / dt - r.dAngle) >> MPU_RATE_SMOOTH;
+    r.dAcc   += ((output.acc - r.acc) * 1000000L / dt - r.dAcc) >> MPU_RATE_SMOOTH;
+    r.dW     += ((output.w   - r.w)   * 1000000L / dt - r.dW)   >> MPU_RATE_SMOOTH;
+  }
+  r.angle = output.angle; r.acc = output.acc; r.w = output.w;
+  r.valid = true;
+
+  output.dAngle = r.dAngle; output.dAcc = r.dAcc; output.dW = r.dW;
+}
+
+//--------------------------------------
+void MPU::record(bool on)
+{
+  if (on && !mRecording)
+  {
+    mRide.reset(new MPURecord[MPU_RIDE_SAMPLES]);
+    mRidePos = mRideLen = 0;
+    mRecording = true;
+    _log << "Mpu recording" << endl;
+  }
+  else if (!on && mRecording)
+  {
+    mRecording = false;
+
+    // oldest 1st
+    size_t len = sizeof(RideHeader) + mRideLen * sizeof(MPURecord);
+    SnapshotPtr buf(new byte[len]);
+    RideHeader* header = (RideHeader*) buf.get();
+    header->magic = MPU_RIDE_MAGIC;
+    header->count = mRideLen;
+
+    MPURecord* recs = (MPURecord*) (buf.get() + sizeof(RideHeader));
+    size_t oldest = mRideLen < MPU_RIDE_SAMPLES ? 0 : mRidePos;
+    for (size_t i = 0; i < mRideLen; i++)
+      recs[i] = mRide[(oldest + i) % MPU_RIDE_SAMPLES];
+
+    mRide.reset();
+    mAllObj->saveFileAsync(MPU_RIDE_FILE, std::move(buf), len);
+    _log << "Mpu recorded " << mRideLen << " measures" << endl;
+  }
+}
+
+//----------------
+// the measures of the ride through process() from a null state, like the loopLeds mapping sees them
+void MPU::replay()
+{
+  const RideHeader* header = (const RideHeader*) mReplay.get();
+  const MPURecord*  recs   = (const MPURecord*) (mReplay.get() + sizeof(RideHeader));
+  size_t            count  = header->count;
+
+  // live state
+  int16_t accY = mAccY, wZ = mWZ, accYsmooth = mAccYsmooth;
+  ulong   dt = mdt;
+  Rates   rates = mRates;
+  mAccY = mWZ = mAccYsmooth = 0;
+  mRates = Rates();
+
+  CRC32        crc;
+  SensorOutput output;
+  ulong        rideTime = 0;
+  long         sumAcc = 0, sumW = 0;
+  int          minAcc = 0, maxAcc = 0, minW = 0, maxW = 0;
+  uint32_t     fwd = 0, rwd = 0, rot = 0;
+  std::unique_ptr<MotionDetector> motion(new MotionDetector); // not on the task stack
+  uint16_t     events[int(MotionEvent::count)] = {};
+  ulong        start = micros();
+
+  // each output against the previous one, as is & extrapolated to its time
+  SensorOutput prev;
+  uint32_t     accHold = 0, accPred = 0, wHold = 0, wPred = 0;
+  int          accPredMax = 0, wPredMax = 0;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const MPURecord& rec = recs[i];
+    mdt = rec.dt;
+    rideTime += rec.dt;
+    #ifdef MPU_FIXED_MATH
+      memcpy(mQuat, rec.quat, sizeof(mQuat));
+    #else
+      mQuat = Quaternion(rec.quat[0] / 16384., rec.quat[1] / 16384., rec.quat[2] / 16384., rec.quat[3] / 16384.);
+    #endif
+    mW.x   = rec.w[0];   mW.y   = rec.w[1];   mW.z   = rec.w[2];
+    mAcc.x = rec.acc[0]; mAcc.y = rec.acc[1]; mAcc.z = rec.acc[2];
+
+    process(output);
+    output.time = rideTime;
+
+    if (i)
+    {
+      SensorOutput pred = prev.predict(rideTime);
+      int accErr = abs(output.acc - pred.acc), wErr = abs(output.w - pred.w);
+      accHold += abs(output.acc - prev.acc); accPred += accErr; accPredMax = max(accPredMax, accErr);
+      wHold   += abs(output.w   - prev.w);   wPred   += wErr;   wPredMax   = max(wPredMax,   wErr);
+    }
+    prev = output;
+
+    MotionEventItem event;
+    motion->push(getMotionSample(output));
+    while (motion->pop(event))
+      events[int(event.type)]++;
+
+    crc.update(output.acc); crc.update(output.w); crc.update(output.angle);
+    sumAcc += output.acc; minAcc = min(minAcc, int(output.acc)); maxAcc = max(maxAcc, int(output.acc));
+    sumW   += output.w;   minW   = min(minW,   int(output.w));   maxW   = max(maxW,   int(output.w));
+    fwd += output.acc > 0; rwd += output.acc < 0; rot += output.w != 0;
+  }
+  ulong us = micros() - start;
+
+  mAccY = accY; mWZ = wZ; mAccYsmooth = accYsmooth; mdt = dt; mRates = rates;
+  mReplay.reset();
+
+  int n = max(int(count), 1);
+  float np = max(int(count) - 1, 1);
+  _log << "replay,measures,rideMs,us,crc,accMin,accMax,accAvg,fwd%,rwd%,wMin,wMax,wAvg,rot%";
+  for (auto name : MOTION_EVENT_NAMES) _log << "," << name;
+  _log << ",dtUs,accHoldErr,accPredErr,accPredMax,wHoldErr,wPredErr,wPredMax";
+  _log << endl;
+  _log << "replay," << count << "," << rideTime / 1000 << "," << us << "," << _HEX(crc.finalize());
+  _log << "," << minAcc << "," << maxAcc << "," << sumAcc / n << "," << fwd * 100 / n << "," << rwd * 100 / n;
+  _log << "," << minW << "," << maxW << "," << sumW / n << "," << rot * 100 / n;
+  for (auto nb : events) _log << "," << nb;
+  _log << "," << rideTime / n << "," << accHold / np << "," << accPred / np << "," << accPredMax;
+  _log << "," << wHold / np << "," << wPred / np << "," << wPredMax;
+  _log << endl;
+}
+
+void MPU::checkReplay()
+{
+  if (mReplaying)
+  {
+    replay();
+    mReplaying = false;
+  }
+}
+
 //--------------------------------------
 void MPU::update()
 {
-  if (!mHasBegun)
-    begin();
+  mBeginAsked = true; // the cfg is loaded
+
+  #ifndef MPU_GET_CORE
+    if (!bringUp()) return; // blocks the loop while it begins
+  #endif
+
+  // ride recorder
+  MPURecord rec;
+  while (mRideQueue.pop(rec))
+    if (mRide)
+    {
+      mRide[mRidePos] = rec;
+      mRidePos = (mRidePos + 1) % MPU_RIDE_SAMPLES;
+      mRideLen = min(mRideLen + 1, size_t(MPU_RIDE_SAMPLES));
+    }
+
+  // background calibration, saved only if it has moved
+  const int16_t* offset = mBias.settled(); // a copy, the mpu task goes on with its own
+  if (offset != nullptr && (!mGotOffset || offset[0] != mXGyroOffset || offset[1] != mYGyroOffset || offset[2] != mZGyroOffset))
+  {
+    mXGyroOffset = offset[0]; mYGyroOffset = offset[1]; mZGyroOffset = offset[2];
+    mGotOffset = true; // with the accel ones kept by syncBias()
+    _log << F("MPU gyro offsets settled: ") << SpaceIt(_WIDTH(mXGyroOffset, 6), _WIDTH(mYGyroOffset, 6), _WIDTH(mZGyroOffset, 6)) << endl;
+    mAllObj->save(CfgType::Current); // written in the background
+  }
+
+  if (mReplayAsked && !mReplaying)
+  {
+    mReplayAsked = false;
+    bool ok = false;
+    {
+      FileObjPtr file = mAllObj->getFile(MPU_RIDE_FILE, FileMode::load);
+      size_t len = file && file->ok() ? file->size() : 0;
+
+      if (len >= sizeof(RideHeader))
+      {
+        mReplay.reset(new byte[len]);
+        const RideHeader* header = (const RideHeader*) mReplay.get();
+        ok = file->read(mReplay.get(), len) == len && header->magic == MPU_RIDE_MAGIC && len == sizeof(RideHeader) + header->count * sizeof(MPURecord);
+      }
+    } // closed & its crc checked, the fs isn't locked during the replay
+
+    if (ok)
+    {
+      #ifdef MPU_GET_CORE
+        mReplaying = true; // by the mpu task
+      #else
+        replay();
+      #endif
+    }
+    else
+    {
+      mReplay.reset();
+      _log << "Mpu replay FAILED, no valid " << MPU_RIDE_FILE << endl;
+    }
+  }
 
   #ifdef MPU_GET_CORE
-    if (xEventGroupGetBits(FlagReady) && xSemaphoreTake(OutputMutex, 0) == pdTRUE) // pool the mpuTask
+    if (SharedOutput.fetch()) // newest complete sample
     {
-      memcpy(&mOutput, &SharedOutput, sizeof(SensorOutput)); 
-      xSemaphoreGive(OutputMutex); // release the mutex after measures have been copied
+      const SensorOutput& output = SharedOutput.front();
+      if (mOutput.seq) mDrops += output.seq - mOutput.seq - 1;
+      mOutput = output;
     }
+    else if (mOutput.seq)
+      mDups++; // the loop goes on with the same sample
+  #elif defined(MPU_DRAIN_FIFO)
+    while (getFiFoPacket())
+      compute(mOutput);
   #else
     if (getFiFoPacket())
       compute(mOutput);
   #endif
 }
+
+//--------------------------------------
+void MPU::showStats()
+{
+  _log << "Mpu sample " << mOutput.seq << " - " << micros() - mOutput.time << "µs old";
+  _log << " - dropped " << mDrops << " - duplicated " << mDups;
+  #ifdef MPU_DRAIN_FIFO
+    _log << " - lost in the fifo " << mLost.load();
+  #endif
+  _log << endl;
+
+  #ifdef MPU_GET_CORE
+    _log << "Mpu task stack never used " << uxTaskGetStackHighWaterMark(NotifyToCalibrate) << " Bytes of " << MPU_GET_STACK << endl;
+  #endif
+
+  #ifdef MPU_CHECK_FIXED
+    _log << "Mpu fixed math max errors: angle " << mMaxAngleErr << " - axis " << mMaxAxisErr << " - smooth " << mMaxSmoothErr << endl;
+  #endif
+}
@@ -0,0 +1,108 @@
+#include <Presets.h>
+
+//--------------------------------------
+void Presets::init()
+{
+  setInPreset(false);
+
+  AddCmdArg ("select",   select(args[0]), 0, PRESET_N - 1) // crossfade to a slot
+  AddCmdArg ("store",    store(args[0]),  0, PRESET_N - 1) // current values in a slot
+  AddVarName("fadeTime", mFadeTime, 1000, 0, 10000)
+}
+
+//--------------------------------------
+void Presets::load()
+{
+  mLen = mAllObj.getSnapshotSize(SnapFilter::preset);
+  size_t len = PRESET_N * mLen;
+  
+  mSlots.reset(new byte[len]);
+  mFrom.reset(new byte[mLen]);
+  mParked.reset(new byte[mLen]);
+
+  // all slots in a single read
+  bool ok = false;
+  {
+    FileObjPtr file = mAllObj.getFile(CFG_PRESETS, FileMode::load);
+    if (file && file->ok())
+      ok = file->size() == len && file->read(mSlots.get(), len) == len;
+  }
+
+  // a slot that doesn't match the vars anymore gets the current values
+  byte nValid = 0;
+  for (byte i = 0; i < PRESET_N; i++)
+  {
+    if (ok && mAllObj.isValid(getSlot(i), mLen))
+      nValid++;
+    else
+      mAllObj.snapshot(getSlot(i), mLen, SnapFilter::preset);
+  }
+
+  _log << "Presets " << nValid << "/" << PRESET_N << " loaded - " << mLen << " Bytes each" << endl;
+}
+
+//----------------
+void Presets::save()
+{
+  size_t len = PRESET_N * mLen;
+  SnapshotPtr buf(new byte[len]);
+  memcpy(buf.get(), mSlots.get(), len);
+  
+  mAllObj.saveFileAsync(CFG_PRESETS, std::move(buf), len);
+}
+
+//--------------------------------------
+void Presets::store(byte i)
+{
+  if (mSlots && mAllObj.snapshot(getSlot(i), mLen, SnapFilter::preset))
+    save();
+}
+
+// the cost of a switch doesn't depend on the values, they are all faded in update()
+void Presets::select(byte i)
+{
+  if (mSlots && mAllObj.snapshot(mFrom.get(), mLen, SnapFilter::preset)) // from the actual values, even if already fading
+  {
+    mTo = getSlot(i);
+    mFadeBegin = millis();
+  }
+}
+
+//----------------
+void Presets::park(byte i)
+{
+  if (!mIsParked && mSlots && mAllObj.snapshot(mParked.get(), mLen, SnapFilter::preset))
+  {
+    mIsParked = true;
+    select(i);
+  }
+}
+
+void Presets::unpark()
+{
+  if (mIsParked && mAllObj.snapshot(mFrom.get(), mLen, SnapFilter::preset))
+  {
+    mIsParked = false;
+    mTo = mParked.get();
+    mFadeBegin = millis();
+  }
+}
+
+//----------------
+void Presets::update()
+{
+  if (mTo != nullptr)
+  {
+    ulong t = millis() - mFadeBegin;
+
+    if (t < mFadeTime)
+      mAllObj.restoreLerp(mFrom.get(), mTo, (t << 16) / mFadeTime, TrackChange::no); // no need to send in-between values
+    else
+    {
+      // the in-between values have synced the sessions, the final one may look unchanged
+      mAllObj.restoreLerp(mTo, nullptr, 0, TrackChange::yes);
+      mAllObj.touch(SnapFilter::preset);
+      mTo = nullptr;
+    }
+  }
+}
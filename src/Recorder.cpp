@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <Recorder.h>
+
+//--------------------------------------
+void Recorder::init()
+{
+  setInPreset(false);
+  mAllObj.addSession(mLoopback);
+
+  AddCmdArg ("record", record(args[0]), 0, 1) // 1 to begin, 0 to save in REC_FILE
+  AddCmd    ("replay", mReplay = true)        // REC_FILE, answers compared to REPLAY_REF
+  AddCmd    ("rebase", rebase())              // the last answers become the reference
+  AddCmd    ("bench",  mBench = true)         // the cmds handling times, logged as csv
+}
+
+//----------------
+void Recorder::update()
+{
+  if (mReplay)
+  {
+    mReplay = false;
+    replay();
+  }
+
+  if (mBench)
+  {
+    mBench = false;
+    mAllObj.bench();
+  }
+}
+
+//----------------
+SnapshotPtr Recorder::load(const char* path, size_t& len)
+{
+  SnapshotPtr buf;
+  FileObjPtr file = mAllObj.getFile(path, FileMode::load);
+
+  if (file && file->ok())
+  {
+    len = file->size();
+    buf.reset(new byte[len]);
+    if (file->read(buf.get(), len) != len) 
+      buf.reset();
+  }
+  return buf;
+}
+
+// a copy is saved, the buffer is kept
+static SnapshotPtr copyOf(const byte* buf, size_t len)
+{
+  SnapshotPtr copy(new byte[len]);
+  memcpy(copy.get(), buf, len);
+  return copy;
+}
+
+//--------------------------------------
+void Recorder::record(bool on)
+{
+  if (on && !mTap.isRecording())
+  {
+    size_t snapLen;
+    SnapshotPtr snap = mAllObj.snapshot(SnapFilter::all, snapLen);
+    size_t len = sizeof(RecHeader) + snapLen;
+
+    if (snap && len < REC_SIZE)
+    {
+      mRec.reset(new byte[REC_SIZE]);
+      RecHeader* header = (RecHeader*) mRec.get();
+      header->magic   = REC_MAGIC;
+      header->snapLen = snapLen;
+      memcpy(mRec.get() + sizeof(RecHeader), snap.get(), snapLen);
+
+      mTap.begin(mRec.get(), REC_SIZE, len);
+      mAllObj.setTap(&mTap);
+      _log << "Recording cmds" << endl;
+    }
+  }
+  else if (!on && mTap.isRecording())
+  {
+    mAllObj.setTap(nullptr);
+    bool full = mTap.isFull();
+    size_t len = mTap.end();
+    _log << "Recorded " << len << " Bytes" << (full ? ", FULL the last cmds are lost" : "") << endl;
+
+    mRecLen = len;
+    mRec = copyOf(mRec.get(), len); // not REC_SIZE
+    mAllObj.saveFileAsync(REC_FILE, copyOf(mRec.get(), len), len);
+  }
+}
+
+//--------------------------------------
+// from the values when the recording began, back to the current ones after
+void Recorder::replay()
+{
+  record(false);
+
+  // the file is still being saved if it's just been recorded
+  size_t len = mRecLen;
+  SnapshotPtr loaded;
+  const byte* rec = mRec.get();
+  if (rec == nullptr) // recorded before a reboot
+  {
+    loaded = load(REC_FILE, len);
+    rec = loaded.get();
+  }
+
+  const RecHeader* header = (const RecHeader*) rec;
+  const byte* snap = rec + sizeof(RecHeader);
+
+  if (rec == nullptr || len < sizeof(RecHeader) || header->magic != REC_MAGIC || !mAllObj.isValid(snap, min(size_t(header->snapLen), len - sizeof(RecHeader))))
+  {
+    _log << "Replay FAILED, no valid " << REC_FILE << endl;
+    return;
+  }
+
+  size_t liveLen;
+  SnapshotPtr live = mAllObj.snapshot(SnapFilter::all, liveLen);
+  mAllObj.restore(snap, header->snapLen, TrackChange::no);
+
+  // a cmd by line
+  SnapshotPtr out(new byte[REPLAY_OUT_SIZE]);
+  size_t      outLen = 0;
+  std::unique_ptr<ulong[]> times(new ulong[REPLAY_MAX_CMDS]);
+  int         nCmds = 0;
+  const byte* p   = snap + header->snapLen;
+  const byte* end = rec + len;
+
+  while (p + sizeof(RecFrame) <= end)
+  {
+    const RecFrame* frame = (const RecFrame*) p;
+    p += sizeof(RecFrame);
+    const byte* frameEnd = min(p + frame->len, end);
+
+    while (p < frameEnd)
+    {
+      const byte* eol = (const byte*) memchr(p, CMD_TERM, frameEnd - p);
+      const byte* next = eol != nullptr ? eol + 1 : frameEnd;
+      mLoopback.inject(p, next - p);
+
+      ulong start = micros();
+      mAllObj.replaySession(mLoopback);
+      ulong t = micros() - start;
+
+      if (eol != nullptr && nCmds < REPLAY_MAX_CMDS) times[nCmds++] = t; // not a partial cmd
+      outLen += mLoopback.drain(out.get() + outLen, REPLAY_OUT_SIZE - outLen);
+      p = next;
+    }
+  }
+
+  mAllObj.restore(live.get(), liveLen, TrackChange::no);
+
+  // latency percentiles
+  std::sort(times.get(), times.get() + nCmds);
+  _log << "Replayed " << nCmds << " cmds";
+  if (nCmds)
+  {
+    _log << " - p50 " << times[nCmds * 50 / 100] << "µs - p90 " << times[nCmds * 90 / 100];
+    _log << "µs - p99 " << times[nCmds * 99 / 100] << "µs - max " << times[nCmds - 1] << "µs";
+  }
+  _log << endl;
+
+  // answers diff
+  if (!mRef) // saved before a reboot
+    mRef = load(REPLAY_REF, mRefLen);
+  
+  const byte* ref = mRef.get();
+  size_t refLen = mRefLen;
+  if (ref != nullptr)
+  {
+    size_t n = min(refLen, outLen);
+    size_t i = 0;
+    while (i < n && ref[i] == out[i]) i++;
+
+    if (i == n && refLen == outLen)
+      _log << "Replay answers identical to " << REPLAY_REF << " - " << outLen << " Bytes" << endl;
+    else
+      _log << "Replay answers DIFFER from " << REPLAY_REF << " @ Byte " << i << " - " << outLen << "/" << refLen << " Bytes" << endl;
+  }
+
+  mOutLen = outLen;
+  mOut = copyOf(out.get(), outLen); // not REPLAY_OUT_SIZE
+  mAllObj.saveFileAsync(REPLAY_OUT, std::move(out), outLen);
+  if (ref == nullptr) rebase(); // the 1st replay is the reference
+}
+
+//----------------
+void Recorder::rebase()
+{
+  if (!mOut) // replayed before a reboot
+    mOut = load(REPLAY_OUT, mOutLen);
+
+  if (mOut)
+  {
+    mRefLen = mOutLen;
+    mRef = copyOf(mOut.get(), mOutLen);
+    mAllObj.saveFileAsync(REPLAY_REF, copyOf(mOut.get(), mOutLen), mOutLen);
+  }
+}
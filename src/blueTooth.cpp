@@ -1,8 +1,12 @@
-#include <Bluetooth.h>
+#include <blueTooth.h>
+#include <AllObj.h>
+
+static_assert(BT_RX_SIZE >= BULK_MAX + LEX_WORDS, "a bulk cfg has to fit in the BT rx ring");
 
 // needed in static onEvent
-bool BlueTooth::mConnected = false;
-long BlueTooth::mStartTime;
+bool      BlueTooth::mConnected = false;
+long      BlueTooth::mStartTime;
+BTStream* BlueTooth::mOpened = nullptr;
 
 //------------------------------------------------------------
 void BlueTooth::onEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t* param)
@@ -12,6 +16,7 @@ void BlueTooth::onEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t* param)
     _log << "BT client connected @ ";
     for (int i = 0; i < 6; i++) _log << _HEX(param->srv_open.rem_bda[i]) << ( i < 5 ? ":" : "\n" );
 
+    if (mOpened != nullptr) mOpened->newClient(); // before its 1st data, in the same BT task
     mConnected = true;
   }
   else if(event == ESP_SPP_CLOSE_EVT)
@@ -27,7 +32,18 @@ void BlueTooth::onEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t* param)
 void BlueTooth::init(const bool on)
 {
   pinMode(BLUE_PIN, OUTPUT); //blue led
+  mOpened = &mStream;
   mBTSerial.register_callback(onEvent);
+  mStream.begin();
+
+  // runs in the BT task, the data don't go through the BluetoothSerial queue
+  mBTSerial.onData([this](const uint8_t* buf, size_t len)
+  {
+    mStream.push(buf, len);
+    #ifdef DBG_LATENCY
+      mRxTime = micros();
+    #endif
+  });
   start(on);
 }
 
@@ -69,4 +85,111 @@ bool BlueTooth::isReady()
   if (mON && !mConnected && millis() - mStartTime > BT_TIMEOUT) start(false);
   
   return mON && mConnected;
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------
+void BTStream::begin()
+{
+  mTelemetry = xQueueCreate(1, sizeof(Telemetry));
+  if (xTaskCreatePinnedToCore(txTask, "btTxTask", BT_TX_STACK, this, BT_TX_PRIO, &mTxTask, BT_TX_CORE) == pdPASS)
+    _log << "BT sent on Core " << BT_TX_CORE << " with Prio " << BT_TX_PRIO << endl;
+  else
+  {
+    mTxTask = nullptr;
+    _log << "BT send task FAILED" << endl;
+  }
+}
+
+//----------------
+void BTStream::txTask(void* _btStream)
+{
+  BTStream* btStream = (BTStream*) _btStream;
+  uint8_t   packet[BT_TX_MTU];
+
+  for (;;) // forever
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // woken up by flush()
+
+    while (size_t len = btStream->fillPacket(packet))
+    {
+      btStream->mSerial.write(packet, len); // might wait for the SPP congestion to end
+      btStream->mBytes += len;
+      btStream->mPackets++;
+    }
+  }
+}
+
+// as much as possible of the ring, then the telemetry if there's room left & the packet doesn't end in the middle of a line
+size_t BTStream::fillPacket(uint8_t* packet)
+{
+  size_t len = 0;
+  while (len < BT_TX_MTU && mTx.pop(packet[len])) len++;
+
+  Telemetry telemetry;
+  bool lineEnd = (len ? packet[len - 1] : mLastTx) == CMD_TERM; // otherwise kept for the next packet
+  if (lineEnd && len + TELEMETRY_MAX <= BT_TX_MTU && xQueueReceive(mTelemetry, &telemetry, 0) == pdTRUE)
+  {
+    memcpy(packet + len, telemetry.txt, telemetry.len);
+    len += telemetry.len;
+  }
+
+  if (len) mLastTx = packet[len - 1];
+  return len;
+}
+
+//----------------
+// the cfg data can't be lost, wait for room if the ring is full
+size_t BTStream::write(const uint8_t* buf, size_t len)
+{
+  size_t sent = mTx.push(buf, len);
+
+  if (sent < len)
+  {
+    ulong start = micros();
+    while (sent < len)
+    {
+      flush();
+      vTaskDelay(1);
+      sent += mTx.push(buf + sent, len - sent);
+    }
+    mBlocked += micros() - start;
+  }
+  return len;
+}
+
+void BTStream::flush()
+{
+  if (mTxTask != nullptr) xTaskNotifyGive(mTxTask);
+}
+
+//----------------
+// only the latest telemetry line is worth sending
+void BTStream::sendTelemetry(const char* txt, size_t len)
+{
+  Telemetry telemetry;
+  telemetry.len = min(len, sizeof(telemetry.txt));
+  memcpy(telemetry.txt, txt, telemetry.len);
+
+  #ifdef BT_TX_DROP_OLDEST
+    if (uxQueueMessagesWaiting(mTelemetry)) mDrops++;
+    xQueueOverwrite(mTelemetry, &telemetry);
+  #else
+    if (xQueueSend(mTelemetry, &telemetry, 0) != pdTRUE) mDrops++;
+  #endif
+}
+
+//----------------
+bool BTStream::reconnected()
+{
+  if (!mNewClient.exchange(false)) return false;
+
+  mRx.dropUntil(mRxStart);
+  return true;
+}
+
+void BTStream::showStats()
+{
+  _log << "BT sent " << mBytes.load() << " Bytes in " << mPackets.load() << " packets";
+  _log << " - telemetry dropped " << mDrops.load() << " - blocked " << mBlocked.load() << "µs";
+  _log << " - received lost " << mRxLost.load() << " Bytes" << endl;
+}
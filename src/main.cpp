@@ -2,17 +2,25 @@
 #define USE_OTA 
 // #define USE_TELNET 
 // #define USE_LEDSERVER
+// #define USE_CMDSERVER   // the BT cmds on a socket too
 
 // #define DEBUG_RASTER
 // #define DEBUG_LED_INFO
+// #define DEBUG_BT_TX
+// #define DEBUG_MPU_HANDOFF
+// #define DEBUG_MOTION
+// #define DEBUG_IDLE
 
 // --------------------------- 
 #include <ledstrip.h>
 #include <mpu.h>
 #include <myWifi.h>
-#include <Raster.h>
+#include <raster.h>
+#include <Presets.h>
+#include <Recorder.h>
+#include <Idle.h>
 
-#define USE_WIFI (defined(USE_LEDSERVER) || defined(USE_OTA) || defined(USE_TELNET))
+#define USE_WIFI (defined(USE_LEDSERVER) || defined(USE_OTA) || defined(USE_TELNET) || defined(USE_CMDSERVER))
 
 // --------------------------- GLOBALS
 // -- Telnet Serial 
@@ -38,30 +46,36 @@ Stream& _log = Serial;
   LedServer LedServer;
 #endif
 
+// -- CmdServer
+#ifdef USE_CMDSERVER
+  #include  <CmdServer.h>
+  CmdServer CmdServer;
+#endif
+
 // -- wifi & mpu
 myWifi  MyWifi;
 MPU     Mpu;
 
 // -- BT & Cfg
 #ifdef USE_BT
-  #include  <Bluetooth.h>
+  #include  <blueTooth.h>
   #include  <Button.h>
-  #include  <AllObjBT.h>
   Button    Button(BUTTON_PIN, LOW);
-  AllObjBT  AllObj;
   BlueTooth BT;
-  #define   CfgArgs (AllObj, BT, Mpu)
 
 #else
-  #include  <NoBluetooth.h>
-  #include  <AllObj.h>
-  AllObj    AllObj;
-  #define   CfgArgs
+  #include  <NoBlueTooth.h>
 #endif
 
+#include  <AllObjBT.h>
+AllObjBT  AllObj;
+
 #include  <Cfg.h> 
-CFG       Cfg CfgArgs;
+CFG       Cfg(AllObj, Mpu);
 Tweaks    Twk;
+Presets   Preset(AllObj);
+Recorder  Rec(AllObj);
+IdleMode  Idle(Preset);
 
 // -- Strips & Fxs
 AllLedStrips AllStrips;
@@ -99,7 +113,10 @@ void setup()
   AllObj.init();
   Cfg.init();
   Twk.init();
-  Mpu.init();
+  Preset.init();
+  Rec.init();
+  Idle.init();
+  Mpu.init(AllObj);
 
   // -- register Strips & FXs
   AllStrips.addStrips(StripM, StripR, StripF); 
@@ -109,15 +126,17 @@ void setup()
   StripF.addFXs( NameIt(TwinkleF, RunF,    CylonF,  Pacifica) );
 
   // -- Register AllObj
-  AllObj.addObjs( NameIt(Cfg, Mpu, AllStrips, Twk) );            
+  AllObj.addObjs( NameIt(Cfg, Mpu, AllStrips, Twk, Preset, Rec, Idle) );            
   AllStrips.addObjs(AllObj);
 
   AllObj.save(CfgType::Default);        
   AllObj.load(CfgType::Current, TrackChange::no);  // inits' cmd will send the right values to BT
+  Preset.load();
 
   // -- BlueTooth
   #ifdef USE_BT
     BT.init(true); // and start
+    AllObj.addSession(BT);
   #else   
     NoBT();
   #endif
@@ -134,6 +153,10 @@ void setup()
       Telnet.setWelcomeMsg("");
     #endif
 
+    #ifdef USE_CMDSERVER
+      AllObj.addSession(CmdServer);
+    #endif
+
   #else
     MyWifi.stop();
   #endif
@@ -142,10 +165,32 @@ void setup()
 // --------------------------- LOOP
 Raster Raster; 
 
+#ifdef DBG_LATENCY
+  ulong CmdTime = 0; // µs when the last cmd has been received
+#endif
+
 // -- loop Mpu
 inline void loopMpu()
 {
   EVERY_N_MILLISECONDS(MPU_TICK) Mpu.update(); 
+
+  #ifdef DEBUG_MPU_HANDOFF
+    EVERY_N_SECONDS(1) Mpu.showStats();
+  #endif
+
+  #ifdef DEBUG_IDLE
+    EVERY_N_SECONDS(10) Idle.showStats();
+  #endif
+
+  // -- motion events
+  MotionEventItem event;
+  while (Mpu.popEvent(event))
+  {
+    #ifdef DEBUG_MOTION
+      _log << "Motion " << MOTION_EVENT_NAMES[int(event.type)] << " @ " << event.time / 1000 << "ms" << endl;
+    #endif
+    Idle.onMotion(event.type); // parked or back to full rate before the leds of this loop
+  }
   Raster.add("Mpu");
 }
 
@@ -166,6 +211,10 @@ inline void loopWifi()
         isClient |= LedServer.update();
       #endif
 
+      #ifdef USE_CMDSERVER
+        isClient |= CmdServer.update();
+      #endif
+
       #ifdef USE_OTA
         if (!isClient) Ota.update(); // ota crashes when other socket clients are connected
       #endif
@@ -178,16 +227,28 @@ inline void loopWifi()
 inline void loopBT()
 {
   #ifdef USE_BT
-    EVERY_N_MILLISECONDS(BT_TICK)
-    {
-      if (Button.debounce()) BT.toggle();
-      
-      AllObj.receiveUpdate(BT);
-    }
+    EVERY_N_MILLISECONDS(BT_TICK) if (Button.debounce()) BT.toggle();
+
+    #ifdef DEBUG_BT_TX
+      EVERY_N_SECONDS(1) BT.getStream().showStats();
+    #endif
+
+    #ifdef DBG_LATENCY
+      if (BT.getStream().available()) CmdTime = BT.getRxTime();
+    #endif
     Raster.add("BlueTooth");
   #endif
 }
 
+// -- Loop Cfg
+inline void loopCfg()
+{
+  AllObj.readSessions(); // cmds already received, nothing to do if there's none
+  EVERY_N_MILLISECONDS(CFG_TICK) AllObj.update(); // autosave
+  Rec.update(); // replay
+  Raster.add("Cfg");
+}
+
 // -- Loop Leds
 inline int8_t  sign(int x) { return (x > 0) - (x < 0); }
 inline byte  above0(int x) { return x > 0 ? x : 0; }
@@ -195,10 +256,21 @@ inline byte mapbyte(int x, byte mi, byte ma) { return mi + (((ma - mi) * x) >> 8
 
 inline void loopLeds()
 {
-  EVERY_N_MILLISECONDS(LED_TICK)
+  static CEveryNMillis ledTimer(LED_TICK);
+  ledTimer.setPeriod(Idle.getLedTick(LED_TICK)); // a shorter tick is due at once
+
+  if (ledTimer)
   {
+    // -- cmds transaction & presets crossfade
+    AllObj.applyTransaction();
+    Preset.update();
+
     // -- led setup modified by MPU
-    SensorOutput& mpu = Mpu.mOutput;
+    #ifdef MPU_PREDICT
+      SensorOutput mpu = Mpu.mOutput.predict(micros() + MPU_PREDICT_LEAD); // leads the motion instead of lagging it
+    #else
+      SensorOutput& mpu = Mpu.mOutput;
+    #endif
     if (mpu.updated)
     {
       // -- gyro & acc
@@ -251,10 +323,15 @@ inline void loopLeds()
     // -- Leds update
     AllStrips.update();
     Raster.add("Leds update");
+
+    #ifdef DBG_LATENCY
+      if (CmdTime) _log << "Cmd shown in " << micros() - CmdTime << "µs" << endl;
+      CmdTime = 0;
+    #endif
   }
 
   // -- Leds dithering
-  if (AllStrips.doDither()) Raster.add("Leds dither"); 
+  if (!Idle.isIdle() && AllStrips.doDither()) Raster.add("Leds dither"); 
 
   #ifdef DEBUG_LED_INFO
     EVERY_N_SECONDS(1) AllStrips.showInfo();
@@ -265,11 +342,14 @@ inline void loopLeds()
 void loop()
 {
   Raster.begin();
+  Idle.beginLoop();
 
   loopWifi();
   loopBT();
+  loopCfg();
   loopMpu();
   loopLeds();
 
   Raster.end();
+  Idle.endLoop(); // waits when parked
 }
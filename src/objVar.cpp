@@ -1,8 +1,8 @@
-#include <ObjVar.h>
+#include <objVar.h>
 
 // ------------------------------
 MyVar::MyVar(byte n, const char* name, SetFunc* set, GetFunc* get, int def, int min, int max, bool show) 
-: mName(name), mSetF(set), mGetF(get), mMin(min), mMax(max), mShow(show) 
+: mName(name), mSetF(set), mGetF(get), mMin(min), mMax(max), mShow(show), mN(n) 
 {
   assert(name!=nullptr);
   assert(strchr(name, ' ')==nullptr); // no space !
@@ -22,13 +22,30 @@ void MyVar::getRange(int& min, int& max)
   max = mMax;
 }
 
+//----------------
+byte MyVar::getSize()
+{
+  if (mMin >= 0) 
+    return mMax <= 0xFF ? 1 : (mMax <= 0xFFFF ? 2 : 4);
+  
+  return mMin >= -128 && mMax <= 127 ? 1 : (mMin >= -32768 && mMax <= 32767 ? 2 : 4);
+}
+
 //----------------
 void MyVar::set(SetArgs toSet, byte n, TrackChange trackChange)
 {
   (*mSetF)(toSet, n); // toSet is read
 
   if (trackChange == TrackChange::no) // handled as nothing as changed... so
-    get(mLast); // write new values in mLast
+    for (byte i=0; i < MAX_SESSIONS; i++)
+      sync(i);
+}
+
+//----------------
+void MyVar::sync(byte cursor)
+{
+  get(mLast[cursor]); // write new values in mLast
+  mTouched &= ~(1 << cursor);
 }
 
 //----------------
@@ -38,15 +55,21 @@ byte MyVar::get(GetArgs toGet)
 }
 
 //----------------
-bool MyVar::hasChanged()
+bool MyVar::hasChanged(byte cursor)
 {
+  if (mTouched & (1 << cursor))
+  {
+    sync(cursor);
+    return true;
+  }
+
   Args cur; 
   byte n = get(cur); // write current values in cur
 
   for (byte j=0; j < n; j++)
-    if (cur[j] != mLast[j])
+    if (cur[j] != mLast[cursor][j])
     {
-      get(mLast); // write new values in mLast
+      sync(cursor);
       return true;
     } 
   return false;
@@ -65,7 +88,10 @@ bool OBJVar::addVar(byte n, const char* name, SetFunc* set, GetFunc* get, int de
     mHash.add(var);
   }
   else
-    _log << ">> ERROR !! Max var is reached " << MAX_VAR << endl; 
+  {
+    _log << ">> ERROR !! Max var is reached " << MAX_VAR << " - " << name << " is not added" << endl; 
+    assert(false); // its member would never get its default value
+  }
     
   return ok;
 }
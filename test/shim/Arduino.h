@@ -0,0 +1,180 @@
+#pragma once
+
+// just enough of the ESP32 Arduino core for the portable sources to run on the host
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <cmath>
+#include <climits>
+#include <cassert>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <string>
+
+typedef uint8_t       byte;
+typedef unsigned long ulong;
+typedef bool          boolean;
+
+#define HEX   16
+#define DEC   10
+#define LOW   0
+#define HIGH  1
+#define INPUT 0
+#define OUTPUT 1
+#define SDA   21
+#define SCL   22
+
+#ifndef PI
+  #define PI 3.1415926535897932384626433832795
+#endif
+
+using std::min;
+using std::max;
+
+template<class T, class L, class H> inline T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) { return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin; }
+
+class __FlashStringHelper;
+#define F(txt) ((const __FlashStringHelper*)(txt))
+
+//-------------------------------
+// the real clock, or a fake one driven by the test
+struct NativeClock
+{
+  bool  fake = false;
+  ulong now  = 0; // µs
+
+  static NativeClock& get() { static NativeClock clock; return clock; };
+
+  ulong micros()
+  {
+    static auto start = std::chrono::steady_clock::now();
+    return fake ? now : std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  void set(ulong us)     { fake = true; now = us; };
+  void advance(ulong us) { fake = true; now += us; };
+  void real()            { fake = false; };
+};
+
+inline ulong micros()           { return NativeClock::get().micros(); }
+inline ulong millis()           { return micros() / 1000; }
+inline void  delay(ulong ms)    { if (NativeClock::get().fake) NativeClock::get().advance(ms * 1000); }
+inline void  pinMode(int, int)  {}
+inline void  digitalWrite(int, int) {}
+inline int   digitalRead(int)   { return 0; }
+
+//-------------------------------
+class Print
+{
+public:
+  virtual ~Print() {};
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) { size_t n = 0; while (len--) n += write(*buf++); return n; };
+  virtual void   flush() {};
+
+  size_t write(const char* txt)                { return write((const uint8_t*)txt, strlen(txt)); };
+  size_t print(const char* txt)                { return write(txt); };
+  size_t print(const __FlashStringHelper* txt) { return write((const char*)txt); };
+  size_t print(const std::string& txt)         { return write(txt.c_str()); };
+  size_t print(char c)                         { return write(uint8_t(c)); };
+  size_t print(long v, int base = DEC)         { char b[24]; snprintf(b, sizeof(b), base == HEX ? "%lX" : "%ld", v); return write(b); };
+  size_t print(ulong v, int base = DEC)        { char b[24]; snprintf(b, sizeof(b), base == HEX ? "%lX" : "%lu", v); return write(b); };
+  size_t print(long long v, int base = DEC)    { return print(long(v), base); };
+  size_t print(unsigned long long v, int base = DEC) { return print(ulong(v), base); };
+  size_t print(int v, int base = DEC)          { return print(long(v), base); };
+  size_t print(unsigned v, int base = DEC)     { return print(ulong(v), base); };
+  size_t print(short v, int base = DEC)        { return print(long(v), base); };
+  size_t print(unsigned short v, int base = DEC) { return print(ulong(v), base); };
+  size_t print(unsigned char v, int base = DEC)  { return print(ulong(v), base); };
+  size_t print(bool v)                         { return print(int(v)); };
+  size_t print(double v, int digits = 2)       { char b[32]; snprintf(b, sizeof(b), "%.*f", digits, v); return write(b); };
+  size_t println()                             { return write("\r\n"); };
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  size_t readBytes(uint8_t* buf, size_t len) { size_t i = 0; while (i < len && available() > 0) buf[i++] = read(); return i; };
+  size_t readBytes(char* buf, size_t len)    { return readBytes((uint8_t*)buf, len); };
+};
+
+//-------------------------------
+struct EspClass
+{
+  void     restart()     {};
+  uint32_t getFreeHeap() { return 0; };
+};
+extern EspClass ESP;
+
+inline uint32_t getCpuFrequencyMhz()         { return 240; }
+inline bool     setCpuFrequencyMhz(uint32_t) { return true; }
+
+//------------------------------- FreeRTOS
+// no task is ever created, so that everything happens in the calling thread & the queues are only read by their creator
+struct NativeQueue
+{
+  size_t                           len, itemSize;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+typedef void*        SemaphoreHandle_t;
+typedef NativeQueue* QueueHandle_t;
+typedef void*        TaskHandle_t;
+typedef uint32_t     TickType_t;
+typedef int          BaseType_t;
+typedef unsigned     UBaseType_t;
+
+#define pdTRUE            1
+#define pdFALSE           0
+#define pdPASS            1
+#define pdFAIL            0
+#define portMAX_DELAY     0xffffffff
+#define pdMS_TO_TICKS(ms) (ms)
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()                        { return nullptr; }
+inline BaseType_t        xSemaphoreTake(SemaphoreHandle_t, TickType_t)  { return pdTRUE; }
+inline BaseType_t        xSemaphoreGive(SemaphoreHandle_t)              { return pdTRUE; }
+
+inline QueueHandle_t     xQueueCreate(UBaseType_t len, UBaseType_t itemSize) { return new NativeQueue { len, itemSize }; }
+inline void              vQueueDelete(QueueHandle_t queue)                   { delete queue; }
+inline UBaseType_t       uxQueueMessagesWaiting(QueueHandle_t queue)         { return queue->items.size(); }
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t)
+{
+  if (queue->items.size() == queue->len) return pdFALSE;
+  queue->items.emplace_back((const uint8_t*)item, (const uint8_t*)item + queue->itemSize);
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t)
+{
+  if (queue->items.empty()) return pdFALSE;
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) // a queue of 1
+{
+  queue->items.clear();
+  return xQueueSend(queue, item, 0);
+}
+
+inline BaseType_t  xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*, BaseType_t) { return pdFAIL; }
+inline TickType_t  xTaskGetTickCount()                     { return millis(); }
+inline void        vTaskDelay(TickType_t ms)               { delay(ms); }
+inline void        vTaskDelayUntil(TickType_t*, TickType_t) {}
+inline BaseType_t  xTaskNotifyGive(TaskHandle_t)           { return pdTRUE; }
+inline uint32_t    ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
@@ -0,0 +1,40 @@
+#pragma once
+
+// a BluetoothSerial driven by the test: a client connects, sends data & gets the packets written
+#include <Arduino.h>
+#include <functional>
+
+enum esp_spp_cb_event_t { ESP_SPP_SRV_OPEN_EVT, ESP_SPP_CLOSE_EVT };
+
+union esp_spp_cb_param_t
+{
+  struct { uint8_t rem_bda[6]; } srv_open;
+};
+
+typedef void (esp_spp_cb_t)(esp_spp_cb_event_t event, esp_spp_cb_param_t* param);
+typedef std::function<void(const uint8_t* buffer, size_t size)> BluetoothSerialDataCb;
+
+class BluetoothSerial
+{
+  esp_spp_cb_t*         mCallback = nullptr;
+  BluetoothSerialDataCb mOnData;
+
+public:
+  std::vector<std::string> packets; // written, one by write
+
+  // -- test side, as the BT task would
+  void event(esp_spp_cb_event_t event)
+  {
+    esp_spp_cb_param_t param = {};
+    if (mCallback != nullptr) mCallback(event, &param);
+  };
+
+  void receive(const char* txt) { if (mOnData) mOnData((const uint8_t*)txt, strlen(txt)); };
+
+  // -- device
+  bool   begin(const char*)                       { return true; };
+  void   end()                                    {};
+  void   register_callback(esp_spp_cb_t* callback) { mCallback = callback; };
+  void   onData(BluetoothSerialDataCb cb)         { mOnData = cb; };
+  size_t write(const uint8_t* buf, size_t len)    { packets.emplace_back((const char*)buf, len); return len; };
+};
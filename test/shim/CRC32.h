@@ -0,0 +1,36 @@
+#pragma once
+
+// same crc as the CRC32 library
+#include <Arduino.h>
+
+class CRC32
+{
+  uint32_t mState = ~0UL;
+
+public:
+  void reset() { mState = ~0UL; };
+
+  void update(const uint8_t& data)
+  {
+    mState ^= data;
+    for (byte i = 0; i < 8; i++)
+      mState = (mState >> 1) ^ (0xEDB88320 & -(mState & 1));
+  };
+
+  template<class T> void update(const T& data) { update(&data, 1); };
+  template<class T> void update(const T* data, size_t len)
+  {
+    const uint8_t* p = (const uint8_t*) data;
+    for (size_t i = 0; i < len * sizeof(T); i++)
+      update(p[i]);
+  };
+
+  uint32_t finalize() const { return ~mState; };
+
+  template<class T> static uint32_t calculate(const T* data, size_t len)
+  {
+    CRC32 crc;
+    crc.update(data, len);
+    return crc.finalize();
+  };
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+// files kept in RAM for the life of the test
+#include <Arduino.h>
+#include <map>
+
+using NativeFiles = std::map<std::string, std::vector<uint8_t>>;
+inline NativeFiles& nativeFiles() { static NativeFiles files; return files; }
+
+class File : public Stream
+{
+  struct Handle
+  {
+    std::string path;
+    size_t      pos  = 0;
+    bool        root = false;
+    NativeFiles::iterator next; // for openNextFile
+  };
+  std::shared_ptr<Handle> mHandle;
+
+  std::vector<uint8_t>& data() { return nativeFiles()[mHandle->path]; };
+
+public:
+  File() {};
+  File(const std::string& path, bool root = false) : mHandle(new Handle)
+  {
+    mHandle->path = path;
+    mHandle->root = root;
+    mHandle->next = nativeFiles().begin();
+  };
+
+  size_t write(uint8_t c) { return write(&c, 1); };
+  size_t write(const uint8_t* buf, size_t len)
+  {
+    std::vector<uint8_t>& d = data();
+    if (mHandle->pos + len > d.size()) d.resize(mHandle->pos + len);
+    memcpy(d.data() + mHandle->pos, buf, len);
+    mHandle->pos += len;
+    return len;
+  };
+
+  int    available() { return *this ? data().size() - mHandle->pos : 0; };
+  int    read()      { return available() > 0 ? data()[mHandle->pos++] : -1; };
+  int    peek()      { return available() > 0 ? data()[mHandle->pos] : -1; };
+  size_t read(uint8_t* buf, size_t len) { return readBytes(buf, len); };
+
+  size_t      size()  { return *this ? data().size() : 0; };
+  const char* name()  { return mHandle->path.c_str(); };
+  void        close() { mHandle.reset(); };
+  operator    bool() const { return mHandle != nullptr; };
+
+  File openNextFile()
+  {
+    if (!mHandle->root || mHandle->next == nativeFiles().end()) return File();
+    return File((mHandle->next++)->first);
+  };
+};
+
+class FS
+{
+public:
+  bool begin(bool formatOnFail = false) { return true; };
+  bool exists(const char* path)         { return nativeFiles().count(path) > 0; };
+  bool remove(const char* path)         { return nativeFiles().erase(path) > 0; };
+
+  File open(const char* path, const char* mode = "r")
+  {
+    if (strcmp(path, "/") == 0) return File(path, true);
+
+    if (mode[0] == 'w')
+      nativeFiles()[path].clear();
+    else if (!exists(path))
+      return File();
+    return File(path);
+  };
+
+  bool rename(const char* from, const char* to)
+  {
+    if (!exists(from)) return false;
+    nativeFiles()[to] = nativeFiles()[from];
+    nativeFiles().erase(from);
+    return true;
+  };
+};
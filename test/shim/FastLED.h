@@ -0,0 +1,21 @@
+#pragma once
+
+// the few FastLED helpers used by the portable sources, same math as lib8tion
+#include <Arduino.h>
+
+typedef uint16_t fract16;
+
+struct CRGB
+{
+  uint8_t r, g, b;
+};
+
+inline uint16_t scale16(uint16_t i, fract16 scale) { return (uint32_t(i) * (1 + uint32_t(scale))) >> 16; }
+
+inline int16_t lerp15by16(int16_t a, int16_t b, fract16 frac)
+{
+  if (b > a)
+    return a + scale16(uint16_t(b - a), frac);
+  else
+    return a - scale16(uint16_t(a - b), frac);
+}
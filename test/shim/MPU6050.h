@@ -0,0 +1,152 @@
+#pragma once
+
+// a MPU6050 fed by the test: MotionApps20 packets in the fifo or raw gyro & accel samples
+#include <Arduino.h>
+#include <helper_3dmath.h>
+
+#define MPU6050_GYRO_FS_2000 0x03
+#define MPU6050_ACCEL_FS_2   0x00
+#define MPU6050_DLPF_BW_188  0x01
+
+#define MPU6050_PACKET_SIZE  42
+
+class MPU6050
+{
+  struct Motion6 { int16_t ax, ay, az, gx, gy, gz; };
+
+  std::deque<std::vector<uint8_t>> mFifo;
+  std::deque<Motion6>              mRaw;
+  Motion6                          mLastRaw = {};
+  int16_t                          mOffset[6] = {}; // accel x y z, gyro x y z
+
+  static void put32(uint8_t* p, int16_t v) { p[0] = v >> 8; p[1] = v; p[2] = p[3] = 0; };
+  static int16_t get16(const uint8_t* p)   { return int16_t((p[0] << 8) | p[1]); };
+
+public:
+  bool    connected = true;
+  uint8_t dmpStatus = 0;
+
+  // -- test side
+  // quaternion 1 = 16384, gyro 2000°/s, accel 1g = 8192 like the dmp
+  void pushPacket(const int16_t* quat, const int16_t* w, const int16_t* acc)
+  {
+    std::vector<uint8_t> packet(MPU6050_PACKET_SIZE, 0);
+    for (byte i = 0; i < 4; i++) put32(&packet[i * 4], quat[i]);
+    for (byte i = 0; i < 3; i++) put32(&packet[16 + i * 4], w[i]);
+    for (byte i = 0; i < 3; i++) put32(&packet[28 + i * 4], acc[i]);
+    mFifo.push_back(packet);
+  };
+
+  // accel 1g = 16384, gyro 2000°/s
+  void pushMotion6(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy, int16_t gz)
+  {
+    mRaw.push_back({ ax, ay, az, gx, gy, gz });
+  };
+
+  // -- device
+  void    initialize()     {};
+  void    reset()          {};
+  void    resetI2CMaster() {};
+  bool    testConnection() { return connected; };
+  uint8_t dmpInitialize()  { return dmpStatus; };
+  void    setDMPEnabled(bool) {};
+
+  void setFullScaleGyroRange(uint8_t)  {};
+  void setFullScaleAccelRange(uint8_t) {};
+  void setDLPFMode(uint8_t)            {};
+  void setRate(uint8_t)                {};
+
+  void CalibrateAccel(uint8_t) {};
+  void CalibrateGyro(uint8_t)  {};
+
+  int16_t getXAccelOffset() { return mOffset[0]; };
+  int16_t getYAccelOffset() { return mOffset[1]; };
+  int16_t getZAccelOffset() { return mOffset[2]; };
+  int16_t getXGyroOffset()  { return mOffset[3]; };
+  int16_t getYGyroOffset()  { return mOffset[4]; };
+  int16_t getZGyroOffset()  { return mOffset[5]; };
+  void    setXAccelOffset(int16_t v) { mOffset[0] = v; };
+  void    setYAccelOffset(int16_t v) { mOffset[1] = v; };
+  void    setZAccelOffset(int16_t v) { mOffset[2] = v; };
+  void    setXGyroOffset(int16_t v)  { mOffset[3] = v; };
+  void    setYGyroOffset(int16_t v)  { mOffset[4] = v; };
+  void    setZGyroOffset(int16_t v)  { mOffset[5] = v; };
+
+  void getMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz)
+  {
+    if (!mRaw.empty())
+    {
+      mLastRaw = mRaw.front();
+      mRaw.pop_front();
+    }
+    *ax = mLastRaw.ax; *ay = mLastRaw.ay; *az = mLastRaw.az;
+    *gx = mLastRaw.gx; *gy = mLastRaw.gy; *gz = mLastRaw.gz;
+  };
+
+  // -- fifo
+  uint16_t getFIFOCount()                   { return mFifo.size() * MPU6050_PACKET_SIZE; };
+  bool     getIntFIFOBufferOverflowStatus() { return false; };
+  void     resetFIFO()                      { mFifo.clear(); };
+
+  void getFIFOBytes(uint8_t* buf, uint8_t len)
+  {
+    for (; len >= MPU6050_PACKET_SIZE && !mFifo.empty(); len -= MPU6050_PACKET_SIZE, buf += MPU6050_PACKET_SIZE)
+    {
+      memcpy(buf, mFifo.front().data(), MPU6050_PACKET_SIZE);
+      mFifo.pop_front();
+    }
+  };
+
+  // -- dmp, MotionApps20 packet layout
+  uint16_t dmpGetFIFOPacketSize() { return MPU6050_PACKET_SIZE; };
+
+  uint8_t dmpGetCurrentFIFOPacket(uint8_t* packet) // the newest one, the older ones are dropped
+  {
+    if (mFifo.empty()) return 0;
+    memcpy(packet, mFifo.back().data(), MPU6050_PACKET_SIZE);
+    mFifo.clear();
+    return 1;
+  };
+
+  uint8_t dmpGetQuaternion(int16_t* data, const uint8_t* packet)
+  {
+    for (byte i = 0; i < 4; i++) data[i] = get16(packet + i * 4);
+    return 0;
+  };
+
+  uint8_t dmpGetQuaternion(Quaternion* q, const uint8_t* packet)
+  {
+    int16_t data[4];
+    dmpGetQuaternion(data, packet);
+    q->w = data[0] / 16384.f; q->x = data[1] / 16384.f; q->y = data[2] / 16384.f; q->z = data[3] / 16384.f;
+    return 0;
+  };
+
+  uint8_t dmpGetGyro(VectorInt16* v, const uint8_t* packet)
+  {
+    v->x = get16(packet + 16); v->y = get16(packet + 20); v->z = get16(packet + 24);
+    return 0;
+  };
+
+  uint8_t dmpGetAccel(VectorInt16* v, const uint8_t* packet)
+  {
+    v->x = get16(packet + 28); v->y = get16(packet + 32); v->z = get16(packet + 36);
+    return 0;
+  };
+
+  uint8_t dmpGetGravity(VectorFloat* v, Quaternion* q)
+  {
+    v->x = 2 * (q->x * q->z - q->w * q->y);
+    v->y = 2 * (q->w * q->x + q->y * q->z);
+    v->z = q->w * q->w - q->x * q->x - q->y * q->y + q->z * q->z;
+    return 0;
+  };
+
+  uint8_t dmpGetLinearAccel(VectorInt16* v, VectorInt16* vRaw, VectorFloat* gravity)
+  {
+    v->x = vRaw->x - gravity->x * 8192;
+    v->y = vRaw->y - gravity->y * 8192;
+    v->z = vRaw->z - gravity->z * 8192;
+    return 0;
+  };
+};
@@ -0,0 +1,3 @@
+#pragma once
+
+// the dmp functions are in MPU6050.h
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+// a Stream written & read in RAM
+class StreamString : public Stream
+{
+  std::string mTxt;
+  size_t      mPos = 0;
+
+public:
+  size_t write(uint8_t c)                      { mTxt += char(c); return 1; };
+  size_t write(const uint8_t* buf, size_t len) { mTxt.append((const char*)buf, len); return len; };
+  int    available() { return mTxt.size() - mPos; };
+  int    read()      { return available() > 0 ? uint8_t(mTxt[mPos++]) : -1; };
+  int    peek()      { return available() > 0 ? uint8_t(mTxt[mPos]) : -1; };
+
+  const char* c_str() const  { return mTxt.c_str(); };
+  size_t      length() const { return mTxt.size(); };
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+// the Streaming library operators used by the sources
+#include <Arduino.h>
+
+template<class T> inline Print& operator<<(Print& obj, T arg) { obj.print(arg); return obj; }
+
+enum _EndLineCode { endl };
+inline Print& operator<<(Print& obj, _EndLineCode) { obj.println(); return obj; }
+
+struct _BASED
+{
+  long val;
+  int  base;
+  _BASED(long v, int b) : val(v), base(b) {};
+};
+inline Print& operator<<(Print& obj, const _BASED& arg) { obj.print(arg.val, arg.base); return obj; }
+#define _HEX(a) _BASED(a, HEX)
+
+// widths are not padded, the tests parse the values
+template<class T> struct _WIDTH_ARG { T val; };
+template<class T> inline Print& operator<<(Print& obj, const _WIDTH_ARG<T>& arg) { return obj << arg.val; }
+#define _WIDTH(a, w)     (_WIDTH_ARG<decltype(a)>{ a })
+#define _WIDTHZ(a, w)    (_WIDTH_ARG<decltype(a)>{ a })
+#define _FLOATW(a, p, w) (_WIDTH_ARG<double>{ double(a) })
+
+// each % replaced by the next arg
+class _FMT_ARGS : public Print
+{
+  std::string mTxt;
+
+public:
+  using Print::write;
+  size_t write(uint8_t c) { mTxt += char(c); return 1; };
+  const std::string& str() const { return mTxt; };
+
+  void format(const char* fmt)
+  {
+    print(fmt);
+  };
+
+  template<class T, class... Args> void format(const char* fmt, T arg, Args... args)
+  {
+    const char* p = strchr(fmt, '%');
+    if (p == nullptr) { print(fmt); return; }
+
+    write((const uint8_t*)fmt, p - fmt);
+    *this << arg;
+    format(p + 1, args...);
+  };
+};
+
+template<class... Args> inline _FMT_ARGS _FMT(const __FlashStringHelper* fmt, Args... args)
+{
+  _FMT_ARGS out;
+  out.format((const char*)fmt, args...);
+  return out;
+}
+inline Print& operator<<(Print& obj, const _FMT_ARGS& arg) { obj.print(arg.str()); return obj; }
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <Arduino.h>
+
+struct TwoWire
+{
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0) { return true; };
+};
+extern TwoWire Wire;
@@ -0,0 +1,6 @@
+#pragma once
+
+typedef int esp_err_t;
+
+#define ESP_OK                    0
+#define ESP_ERR_NVS_NO_FREE_PAGES 0x110d
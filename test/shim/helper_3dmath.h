@@ -0,0 +1,35 @@
+#pragma once
+
+// the I2Cdevlib vector & quaternion types used by the sources
+#include <math.h>
+#include <stdint.h>
+
+class Quaternion
+{
+public:
+  float w = 1, x = 0, y = 0, z = 0;
+
+  Quaternion() {};
+  Quaternion(float nw, float nx, float ny, float nz) : w(nw), x(nx), y(ny), z(nz) {};
+
+  float getMagnitude() { return sqrt(w * w + x * x + y * y + z * z); };
+  void  normalize()    { float m = getMagnitude(); w /= m; x /= m; y /= m; z /= m; };
+};
+
+class VectorInt16
+{
+public:
+  int16_t x = 0, y = 0, z = 0;
+
+  VectorInt16() {};
+  VectorInt16(int16_t nx, int16_t ny, int16_t nz) : x(nx), y(ny), z(nz) {};
+};
+
+class VectorFloat
+{
+public:
+  float x = 0, y = 0, z = 0;
+
+  VectorFloat() {};
+  VectorFloat(float nx, float ny, float nz) : x(nx), y(ny), z(nz) {};
+};
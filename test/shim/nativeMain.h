@@ -0,0 +1,125 @@
+#pragma once
+
+// the globals of the shims, included once by each test
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <Wire.h>
+#include <map>
+
+EspClass ESP;
+FS       SPIFFS;
+TwoWire  Wire;
+
+// _log to stdout, also kept so that a test can parse what's been logged
+class NativeLog : public Stream
+{
+  std::string mTxt;
+
+public:
+  size_t write(uint8_t c) { mTxt += char(c); putchar(c); return 1; };
+  int    available() { return 0; };
+  int    read()      { return -1; };
+  int    peek()      { return -1; };
+
+  const std::string& txt() const { return mTxt; };
+  void               clear()     { mTxt.clear(); };
+
+  // the last csv line that begins with key, by the names of the header logged before it
+  std::map<std::string, std::string> csv(const char* key) const
+  {
+    std::map<std::string, std::string> values;
+    std::vector<std::string> rows;
+    std::string prefix = std::string(key) + ",";
+
+    for (size_t pos = 0; pos < mTxt.size();)
+    {
+      size_t end = mTxt.find('\n', pos);
+      if (end == std::string::npos) end = mTxt.size();
+      std::string line = mTxt.substr(pos, end - pos);
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.compare(0, prefix.size(), prefix) == 0) rows.push_back(line);
+      pos = end + 1;
+    }
+    if (rows.size() < 2) return values;
+
+    auto split = [](const std::string& line)
+    {
+      std::vector<std::string> fields;
+      for (size_t pos = 0, comma; pos <= line.size(); pos = comma + 1)
+      {
+        comma = line.find(',', pos);
+        if (comma == std::string::npos) comma = line.size();
+        fields.push_back(line.substr(pos, comma - pos));
+      }
+      return fields;
+    };
+
+    std::vector<std::string> names = split(rows[rows.size() - 2]), row = split(rows.back());
+    for (size_t i = 0; i < names.size() && i < row.size(); i++)
+      values[names[i]] = row[i];
+    return values;
+  };
+};
+
+NativeLog NativeLogStream;
+Stream&   _log = NativeLogStream;
+
+//-------------------------------
+// the mpu tests, #define NATIVE_MPU before including this: the Mpu in All with a loopback session
+#ifdef NATIVE_MPU
+#include <AllObj.h>
+#include <mpu.h>
+
+AllObj            All;
+MPU               Mpu;
+LoopbackTransport Phone;
+
+void nativeMpuInit()
+{
+  NativeClock::get().set(0);
+
+  All.init();
+  Mpu.init(All);
+  All.addObjs(Mpu, "Mpu");
+  All.addSession(Phone);
+}
+
+void send(const char* cmds)
+{
+  Phone.inject(cmds);
+  All.readSessions();
+}
+
+// n dmp packets 10ms apart, packet(i, quat, w, acc) fills the ith one
+template <class PacketFn>
+void ride(int n, PacketFn packet)
+{
+  for (int i = 0; i < n; i++)
+  {
+    int16_t quat[4], w[3], acc[3];
+    packet(i, quat, w, acc);
+
+    NativeClock::get().advance(10000);
+    Mpu.pushPacket(quat, w, acc);
+    Mpu.update();
+  }
+  Mpu.update(); // the last measure handed to the loop
+}
+
+template <class PacketFn>
+void recordRide(int n, PacketFn packet)
+{
+  send("set Mpu record 1\n");
+  ride(n, packet);
+  send("set Mpu record 0\n");
+}
+
+// the csv of the ride replayed with the current tweaks, empty if it failed
+std::map<std::string, std::string> replayCsv()
+{
+  NativeLogStream.clear();
+  send("set Mpu replay\n");
+  Mpu.update();
+  return NativeLogStream.csv("replay");
+}
+#endif
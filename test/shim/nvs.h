@@ -0,0 +1,60 @@
+#pragma once
+
+// a few u32 keys in RAM, included in an extern "C" block
+#include <stdint.h>
+#include <string.h>
+
+typedef uint32_t nvs_handle;
+
+#define NVS_READWRITE        1
+#define NVS_KEYS             32
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+
+typedef struct { char key[16]; uint32_t value; int used; } nvs_entry;
+
+static inline nvs_entry* nvs_entries(void) { static nvs_entry entries[NVS_KEYS]; return entries; }
+
+static inline nvs_entry* nvs_find(const char* key, int add)
+{
+  nvs_entry* e = nvs_entries();
+  for (int i = 0; i < NVS_KEYS; i++)
+    if (e[i].used && strncmp(e[i].key, key, sizeof(e[i].key) - 1) == 0)
+      return &e[i];
+
+  if (add)
+    for (int i = 0; i < NVS_KEYS; i++)
+      if (!e[i].used)
+      {
+        strncpy(e[i].key, key, sizeof(e[i].key) - 1);
+        e[i].used = 1;
+        return &e[i];
+      }
+  return NULL;
+}
+
+static inline int nvs_open(const char*, int, nvs_handle* handle) { *handle = 1; return 0; }
+static inline int nvs_commit(nvs_handle) { return 0; }
+
+static inline int nvs_set_u32(nvs_handle, const char* key, uint32_t value)
+{
+  nvs_entry* e = nvs_find(key, 1);
+  if (e == NULL) return ESP_ERR_NVS_NOT_FOUND;
+  e->value = value;
+  return 0;
+}
+
+static inline int nvs_get_u32(nvs_handle, const char* key, uint32_t* value)
+{
+  nvs_entry* e = nvs_find(key, 0);
+  if (e == NULL) return ESP_ERR_NVS_NOT_FOUND;
+  *value = e->value;
+  return 0;
+}
+
+static inline int nvs_erase_key(nvs_handle, const char* key)
+{
+  nvs_entry* e = nvs_find(key, 0);
+  if (e == NULL) return ESP_ERR_NVS_NOT_FOUND;
+  e->used = 0;
+  return 0;
+}
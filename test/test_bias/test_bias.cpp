@@ -0,0 +1,104 @@
+#include <unity.h>
+#include <nativeMain.h>
+#include <BiasEstimator.h>
+
+// the gyro bias seen through the offset registers, 1 gyro LSB = BIAS_OFFSET_SCALE register LSB
+BiasEstimator Bias;
+const int16_t Zero[3] = {};
+const int16_t GyroBias[3] = { 10, -7, 3 };
+int           NSettled;
+
+VectorInt16 measure(int i, int jitter = 3)
+{
+  const int16_t* offset = Bias.getOffset();
+  int16_t w[3];
+  for (byte j = 0; j < 3; j++)
+    w[j] = lround(GyroBias[j] + offset[j] / float(BIAS_OFFSET_SCALE)) + (i & 1 ? jitter : -jitter);
+  return VectorInt16(w[0], w[1], w[2]);
+}
+
+// true when the offsets have been written
+bool feed(const VectorInt16& w)
+{
+  bool written = Bias.push(w, VectorInt16(0, 0, 8192));
+  if (Bias.settled() != nullptr) NSettled++;
+  return written;
+}
+
+// the offset registers moved by each still window
+void stillWindows(int n)
+{
+  for (int k = 0; k < n; k++)
+  {
+    int16_t before[3];
+    memcpy(before, Bias.getOffset(), sizeof(before));
+
+    for (int i = 0; i < BIAS_WINDOW - 1; i++)
+      TEST_ASSERT_FALSE(feed(measure(i)));
+    bool written = feed(measure(BIAS_WINDOW - 1));
+    TEST_ASSERT_EQUAL(memcmp(before, Bias.getOffset(), sizeof(before)) != 0, written);
+
+    for (byte j = 0; j < 3; j++)
+      TEST_ASSERT_INT_WITHIN(BIAS_STEP, before[j], Bias.getOffset()[j]);
+  }
+}
+
+void setUp()
+{
+  Bias.reset(Zero);
+  Bias.settled(); // nothing left from a previous test
+  NSettled = 0;
+}
+
+void tearDown() {}
+
+//-------------------------------
+void test_converge()
+{
+  stillWindows(1);
+  for (byte j = 0; j < 3; j++) // the 1st window is the estimate, a whole step
+    TEST_ASSERT_EQUAL(GyroBias[j] > 0 ? -BIAS_STEP : BIAS_STEP, Bias.getOffset()[j]);
+
+  stillWindows(100);
+  for (byte j = 0; j < 3; j++)
+    TEST_ASSERT_INT_WITHIN(1, -BIAS_OFFSET_SCALE * GyroBias[j], Bias.getOffset()[j]);
+}
+
+// published once the offsets stop moving, not again while they stay
+void test_settled_once()
+{
+  int quiet = 0; // still windows since the offsets last moved
+  for (int k = 0; k < 100; k++)
+  {
+    int16_t before[3];
+    memcpy(before, Bias.getOffset(), sizeof(before));
+    stillWindows(1);
+    quiet = memcmp(before, Bias.getOffset(), sizeof(before)) ? 0 : quiet + 1;
+
+    TEST_ASSERT_EQUAL(quiet >= BIAS_SETTLED ? 1 : 0, NSettled);
+  }
+  TEST_ASSERT_EQUAL(1, NSettled);
+}
+
+// a moving sample begins a new window
+void test_moving_resets()
+{
+  for (int i = 0; i < BIAS_WINDOW - 1; i++)
+    TEST_ASSERT_FALSE(feed(measure(i)));
+
+  TEST_ASSERT_FALSE(feed(measure(0, 100)));
+  for (int i = 0; i < BIAS_WINDOW - 1; i++)
+    TEST_ASSERT_FALSE(feed(measure(i)));
+
+  TEST_ASSERT_TRUE(feed(measure(BIAS_WINDOW - 1)));
+}
+
+//-------------------------------
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_converge);
+  RUN_TEST(test_settled_once);
+  RUN_TEST(test_moving_resets);
+  return UNITY_END();
+}
@@ -0,0 +1,112 @@
+#include <unity.h>
+#include <nativeMain.h>
+#include <blueTooth.h>
+#include <AllObj.h>
+
+// the packets sent to the phone, as the BT send task gathers them, & the cmds of its successive clients
+struct Board : public OBJVar
+{
+  byte bright;
+  void init() { AddVar(bright, 7, 0, 255) };
+};
+
+AllObj    All;
+Board     Brd;
+BlueTooth BT;
+
+std::string sendAll()
+{
+  uint8_t     packet[BT_TX_MTU];
+  std::string sent;
+  while (size_t len = BT.getStream().fillPacket(packet))
+    sent.append((char*)packet, len);
+  return sent;
+}
+
+void telemetry(const char* txt) { BT.sendTelemetry(txt, strlen(txt)); }
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+// a cfg dump longer than a packet, the telemetry never in the middle of its lines
+void test_telemetry_between_lines()
+{
+  std::string cfg;
+  for (int i = 100; cfg.size() < BT_TX_MTU * 3 / 2; i++)
+    cfg += "set Board bright " + std::to_string(i) + "\n";
+  TEST_ASSERT_TRUE(cfg[BT_TX_MTU - 1] != CMD_TERM); // cut in a line
+
+  BT.getStream().write((const uint8_t*)cfg.data(), cfg.size());
+  telemetry("U 1 2 3\n");
+
+  uint8_t packet[BT_TX_MTU];
+  size_t  len = BT.getStream().fillPacket(packet);
+  TEST_ASSERT_EQUAL(BT_TX_MTU, len);
+  TEST_ASSERT_EQUAL_MEMORY(cfg.data(), packet, len);
+
+  TEST_ASSERT_EQUAL_STRING((cfg.substr(BT_TX_MTU) + "U 1 2 3\n").c_str(), sendAll().c_str());
+}
+
+// the loop hasn't written the end of the line yet
+void test_telemetry_after_partial_line()
+{
+  BT.getStream() << "set Board bri";
+  telemetry("U 4 5 6\n");
+  TEST_ASSERT_EQUAL_STRING("set Board bri", sendAll().c_str());
+
+  BT.getStream() << "ght 5\n";
+  TEST_ASSERT_EQUAL_STRING("ght 5\nU 4 5 6\n", sendAll().c_str());
+}
+
+void test_telemetry_alone()
+{
+  telemetry("U 7 8 9\n");
+  telemetry("U 10 11 12\n"); // the oldest is dropped
+  TEST_ASSERT_EQUAL_STRING("U 10 11 12\n", sendAll().c_str());
+}
+
+//-------------------------------
+// a new client never completes the line of the previous one
+void test_reconnect_read()
+{
+  BT.getSerial().receive("set Board bri");
+  All.readSessions(); // in the session lexer
+  BT.getSerial().event(ESP_SPP_CLOSE_EVT);
+  BT.getSerial().event(ESP_SPP_SRV_OPEN_EVT);
+
+  BT.getSerial().receive("set Board bright 9\n");
+  All.readSessions();
+  TEST_ASSERT_EQUAL(9, Brd.bright);
+}
+
+void test_reconnect_unread()
+{
+  BT.getSerial().receive("set Board bright 3\nset Board bri");
+  BT.getSerial().event(ESP_SPP_CLOSE_EVT);
+  BT.getSerial().event(ESP_SPP_SRV_OPEN_EVT);
+
+  BT.getSerial().receive("set Board bright 10\n");
+  All.readSessions(); // still in the rx ring
+  TEST_ASSERT_EQUAL(10, Brd.bright);
+}
+
+//-------------------------------
+int main()
+{
+  All.init();
+  Brd.init();
+  All.addObjs(Brd, "Board");
+
+  BT.init(true);
+  All.addSession(BT);
+  BT.getSerial().event(ESP_SPP_SRV_OPEN_EVT);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_telemetry_between_lines);
+  RUN_TEST(test_telemetry_after_partial_line);
+  RUN_TEST(test_telemetry_alone);
+  RUN_TEST(test_reconnect_read);
+  RUN_TEST(test_reconnect_unread);
+  return UNITY_END();
+}
@@ -0,0 +1,196 @@
+#include <unity.h>
+#include <nativeMain.h>
+#include <AllObj.h>
+
+AllObj            All;
+
+//-------------------------------
+struct Board : public OBJVar
+{
+  byte    bright;
+  int16_t offset;
+  byte    r, g, b;
+  int     calls = 0;
+  int     picked = 0;
+
+  void init()
+  {
+    AddVar     (bright, 7, 0, 255)
+    AddVarName ("offset", offset, 0, -300, 300)
+    AddVarCode3("rgb", r = args[0]; g = args[1]; b = args[2], r, g, b, 0, 255)
+    AddCmd     ("call", calls++)
+    AddCmdArg  ("pick", picked = args[0], 0, 9)
+    AddCmdArg  ("bulk", All.beginBulk(args[0]), 0, INT_MAX)
+  };
+};
+
+Board             Brd;
+LoopbackTransport Phone;
+
+std::string answer()
+{
+  uint8_t buf[LOOPBACK_SIZE];
+  return std::string((char*)buf, Phone.drain(buf, sizeof(buf)));
+}
+
+void send(const char* cmds)
+{
+  Phone.inject(cmds);
+  All.readSessions();
+}
+
+void setUp()
+{
+  send("set Board bright 7\nset Board offset 0\nset Board rgb 0 0 0\n");
+  answer();
+}
+
+void tearDown() {}
+
+//-------------------------------
+void test_lookup()
+{
+  TEST_ASSERT_EQUAL_PTR(&Brd, All.getObjFromName("Board"));
+  TEST_ASSERT_NULL(All.getObjFromName("Nope"));
+
+  for (auto var : Brd)
+    TEST_ASSERT_EQUAL_PTR(var, Brd.getVarFromName(var->getName()));
+  TEST_ASSERT_NULL(Brd.getVarFromName("nope"));
+}
+
+void test_set_get()
+{
+  send("set Board bright 42\nset Board offset -12\nset Board rgb 1 2 3\n");
+  TEST_ASSERT_EQUAL(42, Brd.bright);
+  TEST_ASSERT_EQUAL(-12, Brd.offset);
+  TEST_ASSERT_EQUAL(1, Brd.r);
+  TEST_ASSERT_EQUAL(2, Brd.g);
+  TEST_ASSERT_EQUAL(3, Brd.b);
+  TEST_ASSERT_EQUAL_STRING("", answer().c_str()); // not echoed to the sender
+}
+
+void test_set_clamped()
+{
+  send("set Board bright 999\nset Board offset -1000\n");
+  TEST_ASSERT_EQUAL(255, Brd.bright);
+  TEST_ASSERT_EQUAL(-300, Brd.offset);
+}
+
+void test_cmd()
+{
+  int calls = Brd.calls;
+  send("set Board call\n");
+  TEST_ASSERT_EQUAL(calls + 1, Brd.calls);
+}
+
+void test_unknown_ignored()
+{
+  send("set Nope bright 1\nset Board nope 1\nset Board bright\n");
+  TEST_ASSERT_EQUAL(7, Brd.bright);
+}
+
+void test_split_cmd()
+{
+  send("set Board bri");
+  TEST_ASSERT_EQUAL(7, Brd.bright);
+  send("ght 9\n");
+  TEST_ASSERT_EQUAL(9, Brd.bright);
+}
+
+// the binary cfg & its text fallback
+void test_save_load()
+{
+  send("set Board bright 42\nset Board rgb 4 5 6\n");
+  All.save(CfgType::Current);
+
+  const std::vector<uint8_t>& file = nativeFiles()[CFG_CURRENT];
+  std::string txt(file.begin(), file.end());
+  TEST_ASSERT_TRUE(txt.find("set Board bright 42") != std::string::npos);
+  TEST_ASSERT_TRUE(txt.find("set Board rgb 4 5 6") != std::string::npos);
+
+  send("set Board bright 1\nset Board rgb 0 0 0\n");
+  All.load(CfgType::Current);
+  TEST_ASSERT_EQUAL(42, Brd.bright);
+  TEST_ASSERT_EQUAL(6, Brd.b);
+
+  send("set Board bright 1\n");
+  All.load(CfgType::Current, TrackChange::yes, CfgFormat::text);
+  TEST_ASSERT_EQUAL(42, Brd.bright);
+}
+
+// only a var set is saved by the autosave, not a cmd with an arg
+void test_autosave()
+{
+  NativeClock::get().set(1000000);
+  All.setAutoSave(true);
+  All.save(CfgType::Current);
+  nativeFiles().erase(CFG_CURRENT);
+
+  send("set Board pick 3\n");
+  TEST_ASSERT_EQUAL(3, Brd.picked);
+  NativeClock::get().advance(AUTOSAVE_WAIT * 1000 + 1000);
+  All.update();
+  TEST_ASSERT_EQUAL(0, nativeFiles().count(CFG_CURRENT));
+
+  send("set Board bright 8\n");
+  NativeClock::get().advance(AUTOSAVE_WAIT * 1000 + 1000);
+  All.update();
+  TEST_ASSERT_EQUAL(1, nativeFiles().count(CFG_CURRENT));
+
+  All.setAutoSave(false);
+  NativeClock::get().real();
+}
+
+// the bytes of a bulk too long are skipped, never read as cmds
+void test_bulk_too_long()
+{
+  std::string line = "set Board offset 123\n", payload;
+  while (payload.size() <= BULK_MAX) payload += line;
+  size_t len = payload.size();
+
+  send((std::string("set Board bulk ") + std::to_string(len) + "\n" + payload.substr(0, len / 2)).c_str());
+  send((payload.substr(len / 2) + "set Board bright 5\n").c_str());
+
+  TEST_ASSERT_EQUAL(0, Brd.offset);
+  TEST_ASSERT_EQUAL(5, Brd.bright);
+  TEST_ASSERT_EQUAL_STRING("bulkdone 0\r\n", answer().c_str());
+}
+
+//-------------------------------
+// csv on stdout: bench,name,ops,bytes,us,ns/op
+void test_bench()
+{
+  NativeLogStream.clear();
+  All.bench();
+  const std::string& log = NativeLogStream.txt();
+
+  for (auto name : { "lookup", "set", "get", "save", "readCmd" })
+  {
+    size_t pos = log.find(std::string("bench,") + name + ",");
+    TEST_ASSERT_TRUE_MESSAGE(pos != std::string::npos, name);
+    TEST_ASSERT_GREATER_THAN(0, atol(log.c_str() + log.find(',', pos + 6) + 1)); // ops
+  }
+  TEST_ASSERT_EQUAL(7, Brd.bright); // set to their own values
+}
+
+//-------------------------------
+int main()
+{
+  All.init();
+  Brd.init();
+  All.addObjs(Brd, "Board");
+  All.addSession(Phone);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_lookup);
+  RUN_TEST(test_set_get);
+  RUN_TEST(test_set_clamped);
+  RUN_TEST(test_cmd);
+  RUN_TEST(test_unknown_ignored);
+  RUN_TEST(test_split_cmd);
+  RUN_TEST(test_save_load);
+  RUN_TEST(test_autosave);
+  RUN_TEST(test_bulk_too_long);
+  RUN_TEST(test_bench);
+  return UNITY_END();
+}
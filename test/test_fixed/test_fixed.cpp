@@ -0,0 +1,75 @@
+#include <unity.h>
+#define NATIVE_MPU
+#include <nativeMain.h>
+#include <random>
+
+// the fixed math against the float one on the same packets, MPU_CHECK_FIXED keeps the max errors
+struct FixedErrors { int angle, axis, smooth; };
+
+FixedErrors getErrors()
+{
+  NativeLogStream.clear();
+  Mpu.showStats();
+  const std::string& log = NativeLogStream.txt();
+
+  FixedErrors errors = { -1, -1, -1 };
+  size_t pos = log.find("fixed math max errors");
+  TEST_ASSERT_TRUE(pos != std::string::npos);
+  sscanf(log.c_str() + pos, "fixed math max errors: angle %d - axis %d - smooth %d", &errors.angle, &errors.axis, &errors.smooth);
+  return errors;
+}
+
+// a packet of the rotation by angle (rad) around the axis, read by the next update after dt
+void feed(float angle, float x, float y, float z, ulong dt)
+{
+  float n = sin(angle / 2) / sqrt(x * x + y * y + z * z);
+  const int16_t quat[4] = { int16_t(lround(cos(angle / 2) * 16384)), int16_t(lround(x * n * 16384)), int16_t(lround(y * n * 16384)), int16_t(lround(z * n * 16384)) };
+  const int16_t w[3]    = { 0, 0, 0 };
+  const int16_t acc[3]  = { 0, 0, 8192 };
+
+  NativeClock::get().advance(dt);
+  Mpu.pushPacket(quat, w, acc);
+  Mpu.update();
+}
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+void test_angles()
+{
+  std::mt19937 rnd(1);
+  std::uniform_real_distribution<float> axis(-1, 1);
+  uint32_t seq = Mpu.mOutput.seq;
+
+  for (int i = 0; i <= 2000; i++) // the whole turn, the asin LUT & its steep ends
+    feed(2 * PI * i / 2000, axis(rnd), axis(rnd), axis(rnd) + 2, 10000);
+  TEST_ASSERT_EQUAL(seq + 2001, Mpu.mOutput.seq); // every packet computed
+
+  FixedErrors errors = getErrors();
+  printf("fixed,angleErr,axisErr,smoothErr\nfixed,%d,%d,%d\n", errors.angle, errors.axis, errors.smooth);
+  TEST_ASSERT_LESS_OR_EQUAL(4, errors.angle); // on MPU_ANGLE_2PI a whole turn, the float one is truncated
+  TEST_ASSERT_LESS_OR_EQUAL(5, errors.axis);  // on 255
+}
+
+// the smooth LUT steps & the float math beyond it
+void test_smooth()
+{
+  for (ulong dt = 1; dt < 40000; dt += 37)
+    feed(1, 0, 0, 1, dt);
+
+  FixedErrors errors = getErrors();
+  printf("fixed,smoothErr\nfixed,%d\n", errors.smooth);
+  TEST_ASSERT_LESS_OR_EQUAL(2, errors.smooth); // on 65536
+}
+
+//-------------------------------
+int main()
+{
+  nativeMpuInit();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_angles);
+  RUN_TEST(test_smooth);
+  return UNITY_END();
+}
@@ -0,0 +1,72 @@
+#include <unity.h>
+#define NATIVE_MPU
+#include <nativeMain.h>
+
+// the Mahony fusion against the orientation the raw gyro & accel samples were made from
+#define GYRO_DEG  16.4  // LSB by °/s
+#define ACC_1G    16384
+
+int angleOf(float deg) { return lround(deg / 360 * MPU_ANGLE_2PI); } // as getAxiSAngle
+
+// seconds of samples at MPU_FUSION_RATE, gyro in °/s & the gravity of a tilt around x
+void feed(float s, float wx, float wy, float wz, float tiltDeg)
+{
+  float tilt = tiltDeg * PI / 180;
+  for (int i = 0; i < s * MPU_FUSION_RATE; i++)
+  {
+    NativeClock::get().advance(1000000 / MPU_FUSION_RATE);
+    Mpu.pushMotion6(0, lround(sin(tilt) * ACC_1G), lround(cos(tilt) * ACC_1G), lround(wx * GYRO_DEG), lround(wy * GYRO_DEG), lround(wz * GYRO_DEG));
+    Mpu.update();
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+// the gyro integrated, the yaw can't be corrected by the accel
+void test_yaw()
+{
+  feed(1, 0, 0, 90, 0);
+  const SensorOutput& out = Mpu.mOutput;
+  printf("fusion,yawAngle,expected\nfusion,%d,%d\n", out.angle, angleOf(90));
+  TEST_ASSERT_INT_WITHIN(3, angleOf(90), out.angle);
+  TEST_ASSERT_INT_WITHIN(2, 255, abs(out.axis.z));
+
+  feed(1, 0, 0, -90, 0); // back to level
+  TEST_ASSERT_INT_WITHIN(3, 0, out.angle);
+}
+
+// from level, the accel pulls the orientation to the tilt it measures
+void test_tilt()
+{
+  feed(5, 0, 0, 0, 30);
+  const SensorOutput& out = Mpu.mOutput;
+  printf("fusion,tiltAngle,expected\nfusion,%d,%d\n", out.angle, angleOf(30));
+  TEST_ASSERT_INT_WITHIN(3, angleOf(30), out.angle);
+  TEST_ASSERT_INT_WITHIN(2, 255, abs(out.axis.x));
+
+  feed(5, 0, 0, 0, 0); // back to level
+  TEST_ASSERT_INT_WITHIN(3, 0, out.angle);
+}
+
+// a gyro bias is held by the accel instead of drifting 12° in 10s
+void test_drift()
+{
+  feed(10, 1.2, 0, 0, 0);
+  const SensorOutput& out = Mpu.mOutput;
+  printf("fusion,driftAngle,uncorrected\nfusion,%d,%d\n", out.angle, angleOf(12));
+  TEST_ASSERT_LESS_OR_EQUAL(angleOf(1.5), out.angle); // bias / MPU_FUSION_KP
+}
+
+//-------------------------------
+int main()
+{
+  nativeMpuInit();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_yaw);
+  RUN_TEST(test_tilt);
+  RUN_TEST(test_drift);
+  return UNITY_END();
+}
@@ -0,0 +1,252 @@
+#include <unity.h>
+#include <nativeMain.h>
+#include <lexer.h>
+#include <random>
+
+//-------------------------------
+// reference: split on ' ', a number if [-]digits or [-]0x hexdigits, false if the lexer has to reject the line
+struct RefToken
+{
+  bool        number;
+  long long   value;
+  std::string word;
+};
+
+bool refLex(const std::string& line, std::vector<RefToken>& tokens)
+{
+  size_t words = 0;
+  for (size_t i = 0, j; i < line.size(); i = j)
+  {
+    while (i < line.size() && line[i] == LEX_DELIM) i++;
+    if (i == line.size()) break;
+    for (j = i; j < line.size() && line[j] != LEX_DELIM; j++);
+    std::string txt = line.substr(i, j - i);
+
+    if (tokens.size() == LEX_TOKENS) return false;
+
+    if (!isdigit(txt[0]) && txt[0] != '-')
+    {
+      words += txt.size() + 1;
+      if (words > LEX_WORDS) return false;
+      tokens.push_back({ false, 0, txt });
+      continue;
+    }
+
+    bool   neg  = txt[0] == '-';
+    size_t k    = neg;
+    int    base = 10;
+    if (txt.size() > k + 1 && txt[k] == '0' && (txt[k + 1] == 'x' || txt[k + 1] == 'X'))
+    {
+      base = 16;
+      k += 2;
+    }
+    if (k == txt.size()) return false;
+
+    long long value = 0;
+    for (; k < txt.size(); k++)
+    {
+      char c = tolower(txt[k]);
+      int  d = isdigit(c) ? c - '0' : (base == 16 && c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1);
+      if (d < 0) return false;
+      value = min(value * base + d, 1LL << 32);
+    }
+    value = constrain(neg ? -value : value, (long long)INT_MIN, (long long)INT_MAX);
+    tokens.push_back({ true, value, "" });
+  }
+  return true;
+}
+
+void lex(Lexer& lexer, const std::string& line)
+{
+  lexer.clear();
+  for (char c : line) lexer.append(c); // as readCmd feeds it
+  lexer.end();
+}
+
+const Token* nth(Lexer& lexer, int n)
+{
+  const Token* token = lexer.first();
+  while (token != nullptr && n--) token = lexer.next();
+  return token;
+}
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+void test_numbers()
+{
+  struct { const char* txt; int value; } cases[] = {
+    { "0", 0 }, { "-0", 0 }, { "42", 42 }, { "-42", -42 },
+    { "2147483647", INT_MAX }, { "-2147483648", INT_MIN },
+    { "99999999999", INT_MAX }, { "-99999999999", INT_MIN }, // saturated
+    { "0x7fffffff", INT_MAX }, { "0XfF", 255 }, { "-0x10", -16 }, { "0xFFFFFFFF", INT_MAX },
+  };
+  Lexer lexer;
+  size_t pos;
+
+  for (auto& c : cases)
+  {
+    lex(lexer, std::string("set Obj var ") + c.txt);
+    TEST_ASSERT_EQUAL_MESSAGE(int(LexError::none), int(lexer.getError(pos)), c.txt);
+    const Token* token = nth(lexer, 3);
+    TEST_ASSERT_NOT_NULL(token);
+    TEST_ASSERT_TRUE_MESSAGE(token->isNumber(), c.txt);
+    TEST_ASSERT_EQUAL_MESSAGE(c.value, token->value, c.txt);
+  }
+}
+
+void test_errors()
+{
+  struct { const char* txt; LexError error; size_t pos; } cases[] = {
+    { "set a b -",        LexError::badNumber,     9 },
+    { "set a b 0x",       LexError::badNumber,     10 },
+    { "set a b 12z4",     LexError::badNumber,     10 },
+    { "set a b 0x1g",     LexError::badNumber,     11 },
+    { "set a b 1 2 3 4 5 6", LexError::tooManyTokens, 18 },
+  };
+  Lexer lexer;
+  size_t pos;
+
+  for (auto& c : cases)
+  {
+    lex(lexer, c.txt);
+    TEST_ASSERT_EQUAL_MESSAGE(int(c.error), int(lexer.getError(pos)), c.txt);
+    TEST_ASSERT_EQUAL_MESSAGE(c.pos, pos, c.txt);
+  }
+
+  lex(lexer, "set " + std::string(LEX_WORDS, 'w'));
+  TEST_ASSERT_EQUAL(int(LexError::wordTooLong), int(lexer.getError(pos)));
+  TEST_ASSERT_EQUAL(LEX_WORDS - 1, pos); // "set\0" & the '\0' of the word share the pool
+
+  lex(lexer, "set  a   b "); // delims in a row
+  TEST_ASSERT_EQUAL(int(LexError::none), int(lexer.getError(pos)));
+  TEST_ASSERT_EQUAL_STRING("b", nth(lexer, 2)->word);
+  TEST_ASSERT_NULL(lexer.next());
+}
+
+// the lexer against the reference on random lines built from the chars that matter
+void test_fuzz()
+{
+  const char   chars[] = "ab -0x19fFz  ";
+  std::mt19937 rnd(1);
+  int          nValid = 0;
+  Lexer        lexer;
+
+  for (int i = 0; i < 100000; i++)
+  {
+    std::string line(rnd() % 80, ' ');
+    for (char& c : line) c = chars[rnd() % (sizeof(chars) - 1)];
+
+    lex(lexer, line);
+    size_t pos;
+    std::vector<RefToken> ref;
+    bool ok = lexer.getError(pos) == LexError::none;
+    TEST_ASSERT_EQUAL_MESSAGE(refLex(line, ref), ok, line.c_str());
+    if (!ok)
+    {
+      TEST_ASSERT_LESS_OR_EQUAL(line.size(), pos); // on a char of the line or its end
+      continue;
+    }
+    nValid++;
+
+    size_t n = 0;
+    for (const Token* token = lexer.first(); token != nullptr; token = lexer.next(), n++)
+    {
+      TEST_ASSERT_LESS_THAN(ref.size(), n);
+      TEST_ASSERT_EQUAL_MESSAGE(ref[n].number, token->isNumber(), line.c_str());
+      if (token->isNumber())
+        TEST_ASSERT_EQUAL_MESSAGE(ref[n].value, token->value, line.c_str());
+      else
+        TEST_ASSERT_EQUAL_STRING(ref[n].word.c_str(), token->word);
+    }
+    TEST_ASSERT_EQUAL_MESSAGE(ref.size(), n, line.c_str());
+  }
+  TEST_ASSERT_GREATER_THAN(10000, nValid); // not only rejected lines
+}
+
+//-------------------------------
+// the path the lexer replaced: BUF + strtok_r + isNumber + strtol, kept for the bench only
+class OldBuf
+{
+  char  mBuf[128];
+  int   mBufPos;
+  char* mLast;
+
+public:
+  const char* first() { return strtok_r(mBuf, " ", &mLast); };
+  const char* next()  { return strtok_r(nullptr, " ", &mLast); };
+  void clear() { mBuf[0] = '\0'; mBufPos = 0; };
+  void append(char c)
+  {
+    if (mBufPos < (int)sizeof(mBuf)-1)
+    {
+      mBuf[mBufPos++] = c;
+      mBuf[mBufPos] = '\0';
+    }
+  };
+};
+
+bool oldIsNumber(const char* txt)
+{
+  for (int i = 0; i < strlen(txt); i++)
+    if (!(isdigit(txt[i]) || txt[i]=='-'))
+      return false;
+
+  return true;
+}
+
+long oldLex(OldBuf& buf, const std::string& line)
+{
+  long sum = 0;
+  buf.clear();
+  for (char c : line) buf.append(c);
+
+  buf.first(); buf.next(); buf.next(); // set obj var
+  for (const char* a = buf.next(); a != nullptr && oldIsNumber(a); a = buf.next())
+    sum += strtol(a, nullptr, 10);
+  return sum;
+}
+
+//-------------------------------
+// csv on stdout: bench,name,lines,us,lines/s
+void test_bench()
+{
+  const std::string line = "set AllStrips rgb 255 128 -12";
+  const long        nLines = 1000000;
+  long              sum = 0;
+  Lexer             lexer;
+
+  ulong start = micros();
+  for (long i = 0; i < nLines; i++)
+  {
+    lex(lexer, line);
+    for (const Token* token = nth(lexer, 3); token != nullptr; token = lexer.next())
+      sum += token->value;
+  }
+  ulong us = max(micros() - start, 1ul);
+
+  OldBuf buf;
+  long   oldSum = 0;
+  start = micros();
+  for (long i = 0; i < nLines; i++)
+    oldSum += oldLex(buf, line);
+  ulong oldUs = max(micros() - start, 1ul);
+
+  printf("bench,name,lines,us,lines/s\n");
+  printf("bench,lexer,%ld,%lu,%.0f\n", nLines, us, nLines * 1e6 / us);
+  printf("bench,strtok,%ld,%lu,%.0f\n", nLines, oldUs, nLines * 1e6 / oldUs);
+  TEST_ASSERT_EQUAL(nLines * (255 + 128 - 12), sum);
+  TEST_ASSERT_EQUAL(sum, oldSum);
+}
+
+//-------------------------------
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_numbers);
+  RUN_TEST(test_errors);
+  RUN_TEST(test_fuzz);
+  RUN_TEST(test_bench);
+  return UNITY_END();
+}
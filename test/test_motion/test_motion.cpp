@@ -0,0 +1,161 @@
+#include <unity.h>
+#define NATIVE_MPU
+#include <nativeMain.h>
+
+// the MotionDetector on synthetic rides, then the events the mpu raises from its packets
+#define LEVEL 8192 // gravity on the board normal, 1g
+
+struct Ride
+{
+  MotionDetector detector;
+  ulong          time = 0; // µs
+  int            events[int(MotionEvent::count)] = {};
+  int            vib = 0;  // vertical shake of a cruise
+
+  // n samples 10ms apart, acc & vert alternate by a LSB & vib so that a ride isn't quiet
+  void run(int n, int acc, int w, int vert = 0, int tilt = LEVEL)
+  {
+    MotionEventItem event;
+    for (int i = 0; i < n; i++)
+    {
+      time += 10000;
+      detector.push({ int16_t(acc + (i & 1)), int16_t(w), int16_t(vert + (i & 1) * vib), int16_t(tilt), time });
+      while (detector.pop(event))
+        events[int(event.type)]++;
+    }
+  };
+
+  int count(MotionEvent type) { return events[int(type)]; };
+  int total()                 { int n = 0; for (int nb : events) n += nb; return n; };
+};
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+void test_idle_moving()
+{
+  Ride ride;
+  ride.run(MOTION_IDLE_TIME / 10 - 10, 0, 0);
+  TEST_ASSERT_EQUAL(0, ride.total()); // not quiet long enough
+  ride.run(20, 0, 0);
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::idle));
+
+  ride.vib = 400;
+  ride.run(100, 100, 30);
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::moving));
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::idle)); // a cruise still shakes the board
+}
+
+void test_brake()
+{
+  Ride ride;
+  ride.vib = 400;
+  ride.run(50, 50, 0);
+  ride.run(30, -200, 0);
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::brake)); // edge triggered
+
+  ride.run(10, 50, 0);  // released
+  ride.run(30, -200, 0); // within MOTION_HOLDOFF
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::brake));
+
+  ride.run(MOTION_HOLDOFF / 10, 50, 0);
+  ride.run(30, -200, 0);
+  TEST_ASSERT_EQUAL(2, ride.count(MotionEvent::brake));
+  TEST_ASSERT_EQUAL(2, ride.total());
+}
+
+void test_kick_turn()
+{
+  Ride ride;
+  ride.vib = 400;
+  ride.run(50, 50, 0);
+  ride.run(10, 50, MOTION_KICK_W - 10);
+  TEST_ASSERT_EQUAL(0, ride.count(MotionEvent::kickTurn));
+
+  ride.run(100, 0, 240); // a long turn is a single kick
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::kickTurn));
+}
+
+void test_bump()
+{
+  Ride ride;
+  ride.vib = 400;
+  ride.run(50, 50, 0);
+  ride.run(2, 50, 0, MOTION_BUMP - 1000); // with the vib
+  TEST_ASSERT_EQUAL(0, ride.count(MotionEvent::bump));
+  ride.run(2, 50, 0, 7000);
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::bump));
+}
+
+void test_pick_up()
+{
+  Ride ride;
+  ride.run(MOTION_WINDOW - 1, 0, 0, 0, 1000);
+  ride.run(5, 0, 0, 0, LEVEL);
+  ride.run(MOTION_WINDOW - 1, 0, 0, 0, 1000);
+  TEST_ASSERT_EQUAL(0, ride.count(MotionEvent::pickUp)); // never the whole window tilted
+
+  ride.run(MOTION_WINDOW, 0, 0, 0, 1000);
+  TEST_ASSERT_EQUAL(1, ride.count(MotionEvent::pickUp));
+}
+
+// the events are dropped, not the mpu task blocked, when the loop is late
+void test_queue_full()
+{
+  Ride ride;
+  MotionEventItem event;
+  ride.vib = 400;
+  for (int i = 0; i < MOTION_EVENTS * 2; i++)
+  {
+    ride.time += 10000;
+    ride.detector.push({ 0, 0, int16_t(i & 1 ? 7000 : 0), LEVEL, ride.time });
+    ride.time += MOTION_HOLDOFF * 1000UL;
+  }
+  int n = 0;
+  while (ride.detector.pop(event)) n++;
+  TEST_ASSERT_LESS_OR_EQUAL(MOTION_EVENTS, n);
+  TEST_ASSERT_GREATER_THAN(0, n);
+}
+
+//-------------------------------
+// dmp packets of a hard brake, the event from the mpu output
+void test_mpu_brake()
+{
+  MotionEventItem event;
+  int brakes = 0;
+
+  for (int i = 0; i < 100; i++)
+  {
+    const int16_t quat[4] = { 16384, 0, 0, 0 };
+    const int16_t w[3]    = { 0, 0, 0 };
+    const int16_t acc[3]  = { 0, int16_t(i < 50 ? 0 : -6000), 8192 };
+
+    NativeClock::get().advance(10000);
+    Mpu.pushPacket(quat, w, acc);
+    Mpu.update();
+    while (Mpu.popEvent(event))
+    {
+      TEST_ASSERT_EQUAL(int(MotionEvent::brake), int(event.type));
+      TEST_ASSERT_GREATER_THAN(50, i);
+      brakes++;
+    }
+  }
+  TEST_ASSERT_EQUAL(1, brakes);
+}
+
+//-------------------------------
+int main()
+{
+  nativeMpuInit();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_idle_moving);
+  RUN_TEST(test_brake);
+  RUN_TEST(test_kick_turn);
+  RUN_TEST(test_bump);
+  RUN_TEST(test_pick_up);
+  RUN_TEST(test_queue_full);
+  RUN_TEST(test_mpu_brake);
+  return UNITY_END();
+}
@@ -0,0 +1,64 @@
+#include <unity.h>
+#define NATIVE_MPU
+#include <nativeMain.h>
+
+// the outputs extrapolated to the next sample against holding the last one, on a replayed ride
+// smooth accel & turns
+void turns(int i, int16_t* quat, int16_t* w, int16_t* acc)
+{
+  quat[0] = 16384 * cos(i * .002); quat[1] = quat[2] = 0; quat[3] = 16384 * sin(i * .002);
+  w[0]    = w[1] = 0;              w[2]    = 300 * sin(i * .02);
+  acc[0]  = 0;                     acc[1]  = 4000 * sin(i * .01); acc[2] = 8192;
+}
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+void test_bounds()
+{
+  SensorOutput out;
+  out.time   = 1000000;
+  out.angle  = MPU_ANGLE_2PI - 10;
+  out.acc    = 100;
+  out.w      = -100;
+  out.dAngle = 100000; // by s
+  out.dAcc   = 1000;
+  out.dW     = -100000;
+
+  SensorOutput same = out.predict(out.time - 10); // not back in time
+  TEST_ASSERT_EQUAL(out.acc, same.acc);
+  TEST_ASSERT_EQUAL(out.time, same.time);
+
+  SensorOutput pred = out.predict(out.time + 10000);
+  TEST_ASSERT_EQUAL(out.acc + 10, pred.acc);
+  TEST_ASSERT_EQUAL(MPU_ANGLE_2PI, pred.angle);                   // a whole turn at most
+  TEST_ASSERT_EQUAL(out.w - MPU_PREDICT_DELTA, pred.w);           // bounded change
+  TEST_ASSERT_EQUAL(out.acc + MPU_PREDICT_MAX / 1000, out.predict(out.time + 1000000).acc); // bounded horizon
+}
+
+// each output predicted from the previous one
+void test_ride_error()
+{
+  recordRide(1000, turns);
+  auto csv = replayCsv();
+  TEST_ASSERT_FALSE(csv.empty());
+
+  float accHold = atof(csv["accHoldErr"].c_str()), accPred = atof(csv["accPredErr"].c_str());
+  float wHold   = atof(csv["wHoldErr"].c_str()),   wPred   = atof(csv["wPredErr"].c_str());
+  printf("predict,accHoldErr,accPredErr,wHoldErr,wPredErr\npredict,%.2f,%.2f,%.2f,%.2f\n", accHold, accPred, wHold, wPred);
+
+  TEST_ASSERT_LESS_THAN(accHold, accPred);
+  TEST_ASSERT_LESS_THAN(wHold, wPred);
+}
+
+//-------------------------------
+int main()
+{
+  nativeMpuInit();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_bounds);
+  RUN_TEST(test_ride_error);
+  return UNITY_END();
+}
@@ -0,0 +1,75 @@
+#include <unity.h>
+#define NATIVE_MPU
+#include <nativeMain.h>
+
+// a ride recorded from dmp packets, then replayed with the current tweaks & summed up as csv
+#define RIDE_PACKETS 1500 // more than MPU_RIDE_SAMPLES, the oldest are overwritten
+
+// accel bursts forward & backward while turning
+void bursts(int i, int16_t* quat, int16_t* w, int16_t* acc)
+{
+  quat[0] = 16384; quat[1] = quat[2] = quat[3] = 0;
+  w[0]    = w[1] = 0;   w[2]   = 100 * cos(i * .03);
+  acc[0]  = 0;          acc[1] = 3000 * sin(i * .05); acc[2] = 8192;
+}
+
+void setUp() {}
+void tearDown() {}
+
+//-------------------------------
+void test_record()
+{
+  recordRide(RIDE_PACKETS, bursts);
+
+  const std::vector<uint8_t>& file = nativeFiles()[MPU_RIDE_FILE];
+  TEST_ASSERT_EQUAL(sizeof(RideHeader) + MPU_RIDE_SAMPLES * sizeof(MPURecord), file.size());
+}
+
+// the same ride gives the same outputs, whatever the live state
+void test_deterministic()
+{
+  auto first = replayCsv();
+  TEST_ASSERT_EQUAL(MPU_RIDE_SAMPLES, atoi(first["measures"].c_str()));
+  TEST_ASSERT_EQUAL(MPU_RIDE_SAMPLES * 10, atoi(first["rideMs"].c_str()));
+  TEST_ASSERT_EQUAL(10000, atoi(first["dtUs"].c_str())); // mean packet interval
+  TEST_ASSERT_GREATER_THAN(0, atoi(first["fwd%"].c_str()));
+  TEST_ASSERT_GREATER_THAN(0, atoi(first["rwd%"].c_str()));
+
+  ride(100, bursts);
+  auto second = replayCsv();
+  TEST_ASSERT_EQUAL_STRING(first["crc"].c_str(), second["crc"].c_str());
+  TEST_ASSERT_EQUAL_STRING(first["accAvg"].c_str(), second["accAvg"].c_str());
+}
+
+// a tweak is seen in the outputs
+void test_tweak()
+{
+  auto before = replayCsv();
+  send("set Mpu neutralAcc 300\n");
+  auto after = replayCsv();
+  send("set Mpu neutralAcc 60\n");
+
+  TEST_ASSERT_TRUE(before["crc"] != after["crc"]);
+  TEST_ASSERT_LESS_THAN(atoi(before["accMax"].c_str()), atoi(after["accMax"].c_str()));
+}
+
+void test_no_ride()
+{
+  nativeFiles().erase(MPU_RIDE_FILE);
+  auto csv = replayCsv();
+  TEST_ASSERT_TRUE(csv.empty());
+  TEST_ASSERT_TRUE(NativeLogStream.txt().find("Mpu replay FAILED") != std::string::npos);
+}
+
+//-------------------------------
+int main()
+{
+  nativeMpuInit();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_record);
+  RUN_TEST(test_deterministic);
+  RUN_TEST(test_tweak);
+  RUN_TEST(test_no_ride);
+  return UNITY_END();
+}
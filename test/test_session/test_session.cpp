@@ -0,0 +1,165 @@
+#include <unity.h>
+#include <nativeMain.h>
+#include <Recorder.h>
+
+// cmds recorded from a session, then replayed in the loopback session of the recorder
+AllObj            All;
+Recorder          Rec(All);
+LoopbackTransport Phone;
+
+struct Board : public OBJVar
+{
+  byte    bright;
+  int16_t offset;
+
+  void init()
+  {
+    AddVar     (bright, 7, 0, 255)
+    AddVarName ("offset", offset, 0, -300, 300)
+  };
+};
+
+Board Brd;
+
+#define SESSION_CMDS 5 // the lines sent by record(), "set Rec record 0" included
+
+void send(const char* cmds)
+{
+  Phone.inject(cmds);
+  All.readSessions();
+}
+
+// a frame by loop
+void record(int bright)
+{
+  char txt[64];
+  send("set Rec record 1\n");
+  snprintf(txt, sizeof(txt), "set Board bright %d\ninit Board bright\n", bright);
+  NativeClock::get().advance(20000);
+  send(txt);
+  NativeClock::get().advance(20000);
+  send("set Board offset -5\ninit Board offset\n");
+  NativeClock::get().advance(20000);
+  send("set Rec record 0\n");
+
+  uint8_t buf[LOOPBACK_SIZE];
+  Phone.drain(buf, sizeof(buf));
+}
+
+void replay()
+{
+  NativeLogStream.clear();
+  send("set Rec replay\n");
+  Rec.update();
+}
+
+size_t logged(const char* txt)
+{
+  return NativeLogStream.txt().find(txt);
+}
+
+void setUp()
+{
+  send("set Board bright 7\nset Board offset 0\n");
+}
+
+void tearDown() {}
+
+//-------------------------------
+void test_frames()
+{
+  record(10);
+
+  const std::vector<uint8_t>& file = nativeFiles()[REC_FILE];
+  TEST_ASSERT_GREATER_THAN(sizeof(RecHeader), file.size());
+  const RecHeader* header = (const RecHeader*) file.data();
+  TEST_ASSERT_EQUAL_HEX32(REC_MAGIC, header->magic);
+
+  // the frames cover the file to its last byte, the last one too
+  const uint8_t* p   = file.data() + sizeof(RecHeader) + header->snapLen;
+  const uint8_t* end = file.data() + file.size();
+  std::vector<std::string> frames;
+  uint32_t time = 0;
+  while (p + sizeof(RecFrame) <= end)
+  {
+    const RecFrame* frame = (const RecFrame*) p;
+    p += sizeof(RecFrame);
+    TEST_ASSERT_TRUE(p + frame->len <= end);
+    TEST_ASSERT_TRUE(frame->time >= time);
+    time = frame->time;
+    frames.push_back(std::string((const char*) p, frame->len));
+    p += frame->len;
+  }
+  TEST_ASSERT_TRUE(p == end);
+
+  TEST_ASSERT_EQUAL(3, frames.size());
+  TEST_ASSERT_EQUAL_STRING("set Board bright 10\ninit Board bright\n", frames[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("set Rec record 0\n", frames[2].c_str());
+  TEST_ASSERT_EQUAL(60, time); // ms since "set Rec record 1"
+}
+
+// the 1st replay becomes the reference, the live values are back after it
+void test_replay()
+{
+  replay();
+  TEST_ASSERT_EQUAL(7, Brd.bright);
+  TEST_ASSERT_EQUAL(0, Brd.offset);
+
+  char txt[32];
+  snprintf(txt, sizeof(txt), "Replayed %d cmds - p50 ", SESSION_CMDS);
+  TEST_ASSERT_TRUE(logged(txt) != std::string::npos);
+  TEST_ASSERT_TRUE(logged("µs - p90 ") > logged("p50"));
+  TEST_ASSERT_TRUE(logged("µs - p99 ") > logged("p90"));
+  TEST_ASSERT_TRUE(logged("Replay answers") == std::string::npos);
+
+  const std::vector<uint8_t>& ref = nativeFiles()[REPLAY_REF];
+  TEST_ASSERT_TRUE(ref == nativeFiles()[REPLAY_OUT]);
+  TEST_ASSERT_TRUE(std::string(ref.begin(), ref.end()).find("10") != std::string::npos);
+}
+
+void test_identical()
+{
+  replay();
+
+  char txt[64];
+  snprintf(txt, sizeof(txt), "Replay answers identical to %s - %d Bytes", REPLAY_REF, int(nativeFiles()[REPLAY_REF].size()));
+  TEST_ASSERT_TRUE(logged(txt) != std::string::npos);
+}
+
+// another session, compared to the 1st one
+void test_differ()
+{
+  record(12);
+  replay();
+
+  const std::vector<uint8_t>& ref = nativeFiles()[REPLAY_REF];
+  const std::vector<uint8_t>& out = nativeFiles()[REPLAY_OUT];
+  TEST_ASSERT_EQUAL(ref.size(), out.size());
+  size_t i = 0;
+  while (i < ref.size() && ref[i] == out[i]) i++;
+  TEST_ASSERT_TRUE(i < ref.size());
+
+  char txt[64];
+  snprintf(txt, sizeof(txt), "Replay answers DIFFER from %s @ Byte %d - %d/%d Bytes", REPLAY_REF, int(i), int(out.size()), int(ref.size()));
+  TEST_ASSERT_TRUE(logged(txt) != std::string::npos);
+}
+
+//-------------------------------
+int main()
+{
+  NativeClock::get().set(0);
+
+  All.init();
+  Brd.init();
+  Rec.init();
+  All.addObjs(Brd, "Board");
+  All.addObjs(Rec, "Rec");
+  All.addSession(Phone);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_frames);
+  RUN_TEST(test_replay);
+  RUN_TEST(test_identical);
+  RUN_TEST(test_differ);
+  return UNITY_END();
+}